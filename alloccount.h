@@ -0,0 +1,56 @@
+#pragma once
+#ifndef _ALLOCCOUNT_H_
+#define _ALLOCCOUNT_H_
+
+#include "include.h"
+
+// Replaces global operator new/delete to count allocations. Include from exactly one translation unit of a test or bench executable.
+
+static std::atomic<uint64_t> g_allocs{ 0 };
+static std::atomic<uint64_t> g_alloc_bytes{ 0 };
+
+void* operator new(size_t n)
+{
+	g_allocs.fetch_add(1, std::memory_order_relaxed);
+	g_alloc_bytes.fetch_add(n, std::memory_order_relaxed);
+	if (void* p = std::malloc(n ? n : 1)) return p;
+	std::abort();
+}
+
+void* operator new(size_t n, std::align_val_t align)
+{
+	g_allocs.fetch_add(1, std::memory_order_relaxed);
+	g_alloc_bytes.fetch_add(n, std::memory_order_relaxed);
+	size_t a = static_cast<size_t>(align);
+#ifdef _WIN32
+	if (void* p = _aligned_malloc(n ? n : 1, a)) return p;
+#else
+	if (void* p = std::aligned_alloc(a, (std::max<size_t>(n, 1) + a - 1) / a * a)) return p;
+#endif
+	std::abort();
+}
+
+void operator delete(void* p) noexcept { std::free(p); }
+void operator delete(void* p, size_t) noexcept { std::free(p); }
+
+void operator delete(void* p, std::align_val_t) noexcept
+{
+#ifdef _WIN32
+	_aligned_free(p);
+#else
+	std::free(p);
+#endif
+}
+
+void operator delete(void* p, size_t, std::align_val_t align) noexcept { operator delete(p, align); }
+
+struct alloc_scope_t
+{
+	uint64_t count = g_allocs.load();
+	uint64_t bytes = g_alloc_bytes.load();
+
+	uint64_t allocs() const { return g_allocs.load() - count; }
+	uint64_t alloc_bytes() const { return g_alloc_bytes.load() - bytes; }
+};
+
+#endif
\ No newline at end of file
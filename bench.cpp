@@ -0,0 +1,288 @@
+#define MPLAYER_HEADLESS
+#include "include.h"
+#include "alloccount.h"
+
+static double ms_since(std::chrono::steady_clock::time_point start)
+{
+	return std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+}
+
+// Both benches drive the player's own per-sample steps from decode.h, minus the queues to the render thread and audio device.
+static uint64_t bench_video(player_t* mpctx, const player_t::media_t* m)
+{
+	de265_decoder_context* decoder = open_video_decoder(mpctx, m->video_track);
+	if (!decoder) return 0;
+
+	uint64_t frames = 0;
+	uint64_t warm_allocs = 0;
+	const uint64_t warmup = 30;
+
+	alloc_scope_t allocs;
+	auto start = std::chrono::steady_clock::now();
+
+	for (size_t idx = 0; idx < m->video_track->samples.size(); ++idx)
+	{
+		push_video_sample(decoder, m, idx);
+
+		int more = 0;
+		do
+		{
+			if (!de265_isOK(de265_decode(decoder, &more))) break;
+
+			player_t::video_frame_t f;
+			while (pull_video_frame(decoder, f))
+			{
+				if (++frames == warmup) warm_allocs = allocs.allocs();
+			}
+		} while (more);
+	}
+
+	double ms = ms_since(start);
+	uint64_t steady = frames > warmup ? allocs.allocs() - warm_allocs : 0;
+
+	printf("video:    %llu frames in %.0f ms, %.1f fps, %d threads, %llu allocs (%.2f/frame after warmup), %zu pool buffers\n",
+		static_cast<unsigned long long>(frames), ms, ms > 0 ? frames * 1000.0 / ms : 0.0, mpctx->decoder_threads,
+		static_cast<unsigned long long>(allocs.allocs()),
+		frames > warmup ? static_cast<double>(steady) / (frames - warmup) : 0.0,
+		mpctx->vframe_pool.allocated());
+
+	de265_free_decoder(decoder);
+	return steady;
+}
+
+static uint64_t bench_audio(player_t* mpctx, const player_t::media_t* m)
+{
+	HANDLE_AACDECODER aac_decoder = open_audio_decoder(m->audio_track);
+	if (!aac_decoder) return 0;
+
+	std::vector<int16_t> pcm(player_t::pcm_chunk_t::max_samples);
+	audio_sink_t sink;
+
+	// Stands in for the audio device, like drain_audio under the virtual clock. It runs on its own thread because one
+	// decoded frame may be queued in several pieces that do not all fit in the ring at once.
+	std::thread device([mpctx]()
+		{
+			player_t::pcm_chunk_t chunk;
+			while (mpctx->pcm_chunks.pop(chunk))
+				mpctx->pcm.skip(chunk.samples);
+		});
+
+	uint64_t frames = 0, samples_in = 0;
+	uint64_t warm_allocs = 0;
+	const uint64_t warmup = 16;
+	int sample_rate = 0;
+
+	alloc_scope_t allocs;
+	auto start = std::chrono::steady_clock::now();
+
+	for (size_t idx = 0; idx < m->audio_track->samples.size(); ++idx)
+	{
+		const CStreamInfo* info = decode_audio_sample(mpctx, aac_decoder, m, idx, pcm);
+		if (!info) continue;
+
+		if (!sink.push(mpctx, pcm.data(), info, 0, 0)) break;
+
+		samples_in += info->frameSize;
+		sample_rate = info->sampleRate;
+
+		if (++frames == warmup) warm_allocs = allocs.allocs();
+	}
+
+	double ms = ms_since(start);
+	double media_ms = sample_rate ? samples_in * 1000.0 / sample_rate : 0.0;
+	uint64_t steady = frames > warmup ? allocs.allocs() - warm_allocs : 0;
+
+	mpctx->set_state(player_t::STOPPED);
+	device.join();
+
+	printf("audio:    %llu frames in %.0f ms, %.0f frames/s, %.0fx realtime, %d -> %d Hz, %llu allocs (%.2f/frame after warmup)\n",
+		static_cast<unsigned long long>(frames), ms, ms > 0 ? frames * 1000.0 / ms : 0.0,
+		ms > 0 ? media_ms / ms : 0.0, sample_rate, mpctx->output_rate,
+		static_cast<unsigned long long>(allocs.allocs()),
+		frames > warmup ? static_cast<double>(steady) / (frames - warmup) : 0.0);
+
+	aacDecoder_Close(aac_decoder);
+	return steady;
+}
+
+// Plain per-sample 4:2:0 chroma, the reference chroma_row_420 is checked against.
+template<typename T>
+static bool chroma_row_matches(const uint8_t* src, int stride, int width, int rows, int sub_w, int y, const uint8_t* out)
+{
+	const T* a = reinterpret_cast<const T*>(src + static_cast<size_t>(std::min(2 * y, rows - 1)) * stride);
+	const T* b = reinterpret_cast<const T*>(src + static_cast<size_t>(std::min(2 * y + 1, rows - 1)) * stride);
+	const T* o = reinterpret_cast<const T*>(out);
+
+	int count = sub_w == 2 ? width : (width + 1) / 2;
+	for (int x = 0; x < count; ++x)
+	{
+		unsigned expected;
+		if (sub_w == 2 || 2 * x + 1 >= width) expected = (a[sub_w == 2 ? x : 2 * x] + b[sub_w == 2 ? x : 2 * x] + 1) >> 1;
+		else expected = (a[2 * x] + a[2 * x + 1] + b[2 * x] + b[2 * x + 1] + 2) >> 2;
+		if (o[x] != expected) return false;
+	}
+	return true;
+}
+
+static int bench_convert()
+{
+	static const struct { const char* name; int width; int height; } sizes[] = { { "1080p", 1920, 1080 }, { "2160p", 3840, 2160 }, { "4320p", 7680, 4320 }, { "odd", 1279, 719 } };
+	int failures = 0;
+
+	for (const auto& size : sizes)
+	{
+		for (int sub_w : { 2, 1 })
+		{
+			for (int bytes : { 1, 2 })
+			{
+				int src_w = sub_w == 2 ? (size.width + 1) / 2 : size.width;
+				int stride = src_w * bytes;
+				int chroma_w = (size.width + 1) / 2;
+				int chroma_h = (size.height + 1) / 2;
+
+				std::vector<uint8_t> plane(static_cast<size_t>(stride) * size.height);
+				std::vector<uint8_t> out(static_cast<size_t>(chroma_w) * bytes);
+				for (size_t i = 0; i < plane.size(); ++i)
+					plane[i] = static_cast<uint8_t>(i * 7 + (i >> 9));
+				if (bytes == 2)
+				{
+					auto* p = reinterpret_cast<uint16_t*>(plane.data());
+					for (size_t i = 0; i < plane.size() / 2; ++i) p[i] &= 0x3FF;
+				}
+
+				bool ok = true;
+				for (int y = 0; y < chroma_h && ok; ++y)
+				{
+					chroma_row_420(plane.data(), stride, src_w, size.height, sub_w, 1, bytes, y, out.data());
+					ok = bytes == 1 ? chroma_row_matches<uint8_t>(plane.data(), stride, src_w, size.height, sub_w, y, out.data())
+						: chroma_row_matches<uint16_t>(plane.data(), stride, src_w, size.height, sub_w, y, out.data());
+					if (!ok) printf("convert:  %s %s %2d-bit: row %d differs from the scalar reference\n", size.name,
+						sub_w == 2 ? "4:2:2" : "4:4:4", bytes == 2 ? 10 : 8, y);
+				}
+				if (!ok)
+				{
+					++failures;
+					continue;
+				}
+
+				uint64_t frames = 0;
+				auto start = std::chrono::steady_clock::now();
+				do
+				{
+					for (int c = 0; c < 2; ++c)
+					{
+						for (int y = 0; y < chroma_h; ++y)
+							chroma_row_420(plane.data(), stride, src_w, size.height, sub_w, 1, bytes, y, out.data());
+					}
+					++frames;
+				} while (ms_since(start) < 250.0 || frames < 3);
+
+				double ms = ms_since(start) / frames;
+				printf("convert:  %s %s %2d-bit -> 4:2:0, %.2f ms/frame, %.0f fps\n", size.name,
+					sub_w == 2 ? "4:2:2" : "4:4:4", bytes == 2 ? 10 : 8, ms, 1000.0 / ms);
+			}
+		}
+	}
+	return failures ? 1 : 0;
+}
+
+int main(int argc, char** argv)
+{
+	if (argc == 2 && !strcmp(argv[1], "--convert"))
+	{
+		printf("dsp:      %s\n", dsp().name);
+		return bench_convert();
+	}
+
+	if (argc < 3)
+	{
+		printf("usage: bench <file> <password> [--threads N | --sweep] [--rate HZ] [--no-video] [--no-audio]\n");
+		printf("       bench --convert\n");
+		return 1;
+	}
+
+	std::string file = argv[1];
+	std::vector<char> password(argv[2], argv[2] + strlen(argv[2]));
+
+	int threads = default_decoder_threads();
+	int out_rate = 48000;
+	bool video = true, audio = true, sweep = false;
+
+	for (int i = 3; i < argc; ++i)
+	{
+		if (!strcmp(argv[i], "--threads") && i + 1 < argc) threads = std::max(0, atoi(argv[++i]));
+		else if (!strcmp(argv[i], "--rate") && i + 1 < argc) out_rate = std::max(1, atoi(argv[++i]));
+		else if (!strcmp(argv[i], "--sweep")) sweep = true;
+		else if (!strcmp(argv[i], "--no-video")) video = false;
+		else if (!strcmp(argv[i], "--no-audio")) audio = false;
+	}
+
+	printf("dsp:      %s\n", dsp().name);
+
+	auto mpctx = std::make_unique<player_t>();
+	mpctx->decoder_threads = threads;
+	mpctx->output_rate = out_rate;
+	mpctx->output_channels = 2;
+	mpctx->state.store(player_t::PLAYING);
+
+	player_t::media_t m;
+
+	auto start = std::chrono::steady_clock::now();
+	m.stream = std::make_unique<memstream_t>(std::filesystem::path(file), password);
+	if (!m.stream->is_valid())
+	{
+		printf("open failed\n");
+		return 4;
+	}
+	printf("open:     %.1f ms, %.1f MB decrypted\n", ms_since(start), m.stream->size() / (1024.0 * 1024.0));
+
+	start = std::chrono::steady_clock::now();
+	m.mp4 = std::make_unique<mp4_t>();
+	if (!m.mp4->parse(m.stream.get()))
+	{
+		printf("parse failed\n");
+		return 5;
+	}
+
+	for (const auto& track : m.mp4->_tracks)
+	{
+		if (!m.video_track && track.type == 'vide') m.video_track = &track;
+		if (!m.audio_track && track.type == 'soun') m.audio_track = &track;
+	}
+
+	printf("parse:    %.1f ms, %zu video samples, %zu audio samples\n", ms_since(start),
+		m.video_track ? m.video_track->samples.size() : 0, m.audio_track ? m.audio_track->samples.size() : 0);
+
+	uint64_t steady_allocs = 0;
+
+	// --sweep decodes the video once per worker count, for comparing decoder scaling on one machine.
+	if (video && m.video_track && !m.video_track->stsd->nal_units.empty())
+	{
+		if (sweep)
+		{
+			for (int n : { 1, 2, 4, 8 })
+			{
+				mpctx->decoder_threads = n;
+				steady_allocs += bench_video(mpctx.get(), &m);
+			}
+		}
+		else
+		{
+			steady_allocs += bench_video(mpctx.get(), &m);
+		}
+	}
+
+	if (audio && m.audio_track && !m.audio_track->stsd->asc_bytes.empty())
+		steady_allocs += bench_audio(mpctx.get(), &m);
+
+	printf("peak rss: %.1f MB\n", peak_working_set_mb());
+
+	// Decoding must not allocate once warmed up; a regression fails the run.
+	if (steady_allocs)
+	{
+		printf("FAILED: %llu allocations after warmup\n", static_cast<unsigned long long>(steady_allocs));
+		return 6;
+	}
+
+	return 0;
+}
\ No newline at end of file
@@ -0,0 +1,82 @@
+#define MPLAYER_HEADLESS
+#include "include.h"
+
+static bool g_mismatch = false;
+
+template<typename Q>
+static double bench_throughput(size_t count)
+{
+	auto q = std::make_unique<Q>();
+
+	auto start = std::chrono::steady_clock::now();
+
+	std::thread producer([&]()
+		{
+			for (uint64_t i = 0; i < count; ++i)
+				q->push(std::move(i));
+		});
+
+	uint64_t value = 0, sum = 0;
+	for (size_t i = 0; i < count; ++i)
+	{
+		q->pop(value);
+		sum += value;
+	}
+
+	producer.join();
+
+	double sec = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+	if (sum != count * (count - 1) / 2)
+	{
+		printf("checksum mismatch\n");
+		g_mismatch = true;
+	}
+	return count / sec / 1e6;
+}
+
+template<typename Q>
+static double bench_latency(size_t count)
+{
+	auto ping = std::make_unique<Q>();
+	auto pong = std::make_unique<Q>();
+
+	std::thread echo([&]()
+		{
+			uint64_t value = 0;
+			for (size_t i = 0; i < count; ++i)
+			{
+				ping->pop(value);
+				pong->push(std::move(value));
+			}
+		});
+
+	auto start = std::chrono::steady_clock::now();
+
+	uint64_t value = 0;
+	for (uint64_t i = 0; i < count; ++i)
+	{
+		ping->push(std::move(i));
+		pong->pop(value);
+	}
+
+	double ns = std::chrono::duration<double, std::nano>(std::chrono::steady_clock::now() - start).count();
+	echo.join();
+	return ns / count / 2;
+}
+
+int main(int argc, char** argv)
+{
+	size_t count = argc > 1 ? strtoull(argv[1], 0, 10) : 10000000;
+	size_t rounds = count / 100;
+
+	using mutex_q = safe_queue<uint64_t, 1024>;
+	using ring_q = spsc_ring<uint64_t, 1024>;
+
+	printf("throughput (Mitems/s): safe_queue %.2f, spsc_ring %.2f\n",
+		bench_throughput<mutex_q>(count), bench_throughput<ring_q>(count));
+
+	printf("handoff latency (ns):  safe_queue %.0f, spsc_ring %.0f\n",
+		bench_latency<mutex_q>(rounds), bench_latency<ring_q>(rounds));
+
+	return g_mismatch ? 1 : 0;
+}
\ No newline at end of file
@@ -0,0 +1,46 @@
+#pragma once
+#ifndef _CLOCK_H_
+#define _CLOCK_H_
+
+#include "include.h"
+
+// Media time source for the pipeline, in microseconds.
+class playback_clock_t
+{
+public:
+	virtual ~playback_clock_t() = default;
+
+	// False when media time does not follow the wall clock; pacing and overload control are then skipped.
+	virtual bool realtime() const = 0;
+
+	virtual int64_t now_us() = 0;
+
+	// Time left until `pts_us` is due. Called by the render thread right before it waits to present.
+	virtual int64_t until_us(int64_t pts_us) = 0;
+
+	// Restarts media time at `base_us`, on start and on seek.
+	virtual void reset(int64_t base_us) = 0;
+};
+
+// Jumps straight to each frame's deadline, so a run takes exactly as long as its work.
+class virtual_clock_t : public playback_clock_t
+{
+public:
+	bool realtime() const override { return false; }
+
+	int64_t now_us() override { return now_.load(); }
+
+	int64_t until_us(int64_t pts_us) override
+	{
+		int64_t now = now_.load();
+		while (pts_us > now && !now_.compare_exchange_weak(now, pts_us)) {}
+		return 0;
+	}
+
+	void reset(int64_t base_us) override { now_.store(base_us); }
+
+private:
+	std::atomic<int64_t> now_{ 0 };
+};
+
+#endif
\ No newline at end of file
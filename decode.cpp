@@ -0,0 +1,106 @@
+#include "include.h"
+
+int default_decoder_threads()
+{
+	int hw = static_cast<int>(std::thread::hardware_concurrency());
+	return std::max(1, hw - player_t::pipeline_threads);
+}
+
+de265_decoder_context* open_video_decoder(player_t* mpctx, const track_t* track)
+{
+	de265_decoder_context* decoder = de265_new_decoder();
+	if (!decoder)
+		return 0;
+
+	mpctx->vframe_pool.attach(decoder);
+
+	if (mpctx->decoder_threads > 0)
+		de265_start_worker_threads(decoder, mpctx->decoder_threads);
+
+	for (const auto& arr : track->stsd->nal_units)
+	{
+		for (const auto& nal : arr)
+			de265_push_NAL(decoder, nal.data(), static_cast<int>(nal.size()), 0, 0);
+	}
+	de265_flush_data(decoder);
+
+	return decoder;
+}
+
+void push_video_sample(de265_decoder_context* decoder, const player_t::media_t* m, size_t idx)
+{
+	const auto& sample = m->video_track->samples[idx];
+	auto data = m->stream->view(sample.file_offset, sample.size);
+
+	uint64_t pts = sample.presentation_time * 1000 / m->video_track->timescale;
+
+	size_t pos = 0;
+	while (pos + 4 <= data.size())
+	{
+		uint32_t nal_len = (data[pos] << 24) | (data[pos + 1] << 16) | (data[pos + 2] << 8) | data[pos + 3];
+		pos += 4;
+		if (pos + nal_len > data.size()) break;
+		de265_push_NAL(decoder, data.data() + pos, static_cast<int>(nal_len), pts, 0);
+		pos += nal_len;
+	}
+}
+
+bool pull_video_frame(de265_decoder_context* decoder, player_t::video_frame_t& f)
+{
+	const de265_image* img = de265_get_next_picture(decoder);
+	if (!img)
+		return false;
+
+	f = {};
+	f.pts = de265_get_image_PTS(img);
+	f.width = de265_get_image_width(img, 0);
+	f.height = de265_get_image_height(img, 0);
+	f.bit_depth = de265_get_bits_per_pixel(img, 0);
+	f.chroma = de265_get_chroma_format(img);
+
+	f.buffer = frame_ref_t(static_cast<frame_buffer_t*>(de265_get_image_plane_user_data(img, 0)));
+
+	for (int c = 0; c < 3; ++c)
+		f.planes[c] = de265_get_image_plane(img, c, &f.strides[c]);
+
+	return true;
+}
+
+HANDLE_AACDECODER open_audio_decoder(const track_t* track)
+{
+	HANDLE_AACDECODER decoder = aacDecoder_Open(TT_MP4_RAW, 1);
+	if (!decoder)
+		return 0;
+
+	auto& asc = track->stsd->asc_bytes;
+	auto ascLen = static_cast<UINT>(asc.size());
+	UCHAR* ascData = const_cast<UCHAR*>(asc.data());
+	aacDecoder_ConfigRaw(decoder, &ascData, &ascLen);
+
+	return decoder;
+}
+
+const CStreamInfo* decode_audio_sample(player_t* mpctx, HANDLE_AACDECODER decoder, const player_t::media_t* m, size_t idx, std::vector<int16_t>& pcm)
+{
+	const auto& sample = m->audio_track->samples[idx];
+	auto data = m->stream->view(sample.file_offset, sample.size);
+
+	UCHAR* ptr = const_cast<UCHAR*>(data.data());
+	UINT buffer_size = static_cast<UINT>(data.size());
+	UINT bytes_valid = static_cast<UINT>(data.size());
+
+	{
+		stage_timer_t timer(mpctx->telemetry, telemetry_t::STAGE_AUDIO_DECODE);
+		if (aacDecoder_Fill(decoder, &ptr, &buffer_size, &bytes_valid) != AAC_DEC_OK)
+			return 0;
+
+		if (aacDecoder_DecodeFrame(decoder, pcm.data(), static_cast<INT>(pcm.size()), 0) != AAC_DEC_OK)
+			return 0;
+	}
+
+	const CStreamInfo* info = aacDecoder_GetStreamInfo(decoder);
+	if (!info || !info->sampleRate || !info->numChannels)
+		return 0;
+
+	return info;
+}
\ No newline at end of file
@@ -0,0 +1,106 @@
+#pragma once
+#ifndef _DECODE_H_
+#define _DECODE_H_
+
+#include "include.h"
+
+// Per-sample decode steps, shared by the player's decode threads and bench so both time the same code.
+
+// libde265 workers: one per core left over after the player's own pipeline threads.
+int default_decoder_threads();
+
+de265_decoder_context* open_video_decoder(player_t* mpctx, const track_t* track);
+void push_video_sample(de265_decoder_context* decoder, const player_t::media_t* m, size_t idx);
+bool pull_video_frame(de265_decoder_context* decoder, player_t::video_frame_t& f);
+
+HANDLE_AACDECODER open_audio_decoder(const track_t* track);
+
+// Decodes sample `idx` into `pcm`; null when the sample produced no usable output.
+const CStreamInfo* decode_audio_sample(player_t* mpctx, HANDLE_AACDECODER decoder, const player_t::media_t* m, size_t idx, std::vector<int16_t>& pcm);
+
+// Mixes, resamples and queues decoded PCM for the audio device.
+struct audio_sink_t
+{
+	std::vector<int16_t> mixed = std::vector<int16_t>(player_t::pcm_chunk_t::max_samples);
+	std::vector<float> planar, resampled, interleaved;
+	std::array<float*, player_t::pcm_chunk_t::max_channels> planar_ptrs{}, resampled_ptrs{};
+	resampler_t resampler;
+
+	bool push(player_t* mpctx, const int16_t* src, const CStreamInfo* info, uint64_t pts, uint32_t serial)
+	{
+		const int out_channels = mpctx->output_channels;
+
+		size_t frames = static_cast<size_t>(info->frameSize);
+		if (frames > player_t::pcm_chunk_t::max_frames)
+			return true;
+
+		size_t produced = 0;
+		{
+			stage_timer_t timer(mpctx->telemetry, telemetry_t::STAGE_AUDIO_FILTER);
+
+			if (info->numChannels != out_channels)
+			{
+				if (info->numChannels == 2 && out_channels == 1)
+					dsp().downmix_s16(src, mixed.data(), frames);
+				else if (info->numChannels == 1 && out_channels == 2)
+					dsp().upmix_s16(src, mixed.data(), frames);
+				else
+					return true;
+				src = mixed.data();
+			}
+
+			if (resampler.in_rate() != info->sampleRate)
+			{
+				if (!resampler.init(info->sampleRate, mpctx->output_rate, out_channels))
+					return false;
+
+				size_t in_len = player_t::pcm_chunk_t::max_frames;
+				size_t out_len = resampler.max_output(in_len);
+				planar.resize(in_len * out_channels);
+				resampled.resize(out_len * out_channels);
+				interleaved.resize(out_len * out_channels);
+
+				for (int c = 0; c < out_channels; ++c)
+				{
+					planar_ptrs[c] = planar.data() + c * in_len;
+					resampled_ptrs[c] = resampled.data() + c * out_len;
+				}
+			}
+
+			deinterleave_s16(src, planar_ptrs.data(), out_channels, frames);
+			produced = resampler.process(planar_ptrs.data(), frames, resampled_ptrs.data());
+			interleave_f32(resampled_ptrs.data(), interleaved.data(), out_channels, produced);
+		}
+
+		// Upsampling can make one decoded frame larger than the whole ring (x6 from 8 kHz), and waiting for that much
+		// space would never return. Such frames are queued in pieces of at most half the ring.
+		const size_t piece_frames = decltype(mpctx->pcm)::max_size / 2 / out_channels;
+
+		for (size_t done = 0; done < produced;)
+		{
+			size_t count = std::min(produced - done, piece_frames);
+
+			player_t::pcm_chunk_t chunk{};
+			chunk.pts = pts + done * 1000 / mpctx->output_rate;
+			chunk.serial = serial;
+			chunk.sample_rate = mpctx->output_rate;
+			chunk.channels = out_channels;
+			chunk.samples = count * out_channels;
+
+			stage_timer_t timer(mpctx->telemetry, telemetry_t::STAGE_AQUEUE_PUSH);
+			if (!mpctx->pcm.wait_space(chunk.samples, [&]() { return mpctx->interrupted(serial); }))
+				return false;
+
+			mpctx->pcm.write(interleaved.data() + done * out_channels, chunk.samples);
+			if (!mpctx->pcm_chunks.push(std::move(chunk)))
+				return false;
+
+			done += count;
+		}
+
+		mpctx->telemetry.depths[telemetry_t::DEPTH_PCM_CHUNKS].record(mpctx->pcm_chunks.size());
+		return true;
+	}
+};
+
+#endif
\ No newline at end of file
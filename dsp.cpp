@@ -0,0 +1,905 @@
+#include "include.h"
+#include <immintrin.h>
+
+#if defined(_MSC_VER) && !defined(__clang__)
+#include <intrin.h>
+#define DSP_TARGET(isa)
+#else
+#define DSP_TARGET(isa) __attribute__((target(isa)))
+#endif
+
+static constexpr float s16_scale = 32768.0f;
+static constexpr float s16_inv_scale = 1.0f / 32768.0f;
+
+static inline int16_t saturate_s16(float v)
+{
+	v = v > -32768.0f ? v : -32768.0f;
+	v = v < 32767.0f ? v : 32767.0f;
+	return static_cast<int16_t>(std::lrintf(v));
+}
+
+static void gain_s16_scalar(int16_t* pcm, size_t count, float gain)
+{
+	for (size_t i = 0; i < count; ++i)
+		pcm[i] = saturate_s16(pcm[i] * gain);
+}
+
+static void f32_to_s16_scalar(const float* in, int16_t* out, size_t count)
+{
+	for (size_t i = 0; i < count; ++i)
+		out[i] = saturate_s16(in[i] * s16_scale);
+}
+
+static void downmix_s16_scalar(const int16_t* in, int16_t* out, size_t frames)
+{
+	for (size_t i = 0; i < frames; ++i)
+		out[i] = static_cast<int16_t>((in[2 * i] + in[2 * i + 1]) >> 1);
+}
+
+static void upmix_s16_scalar(const int16_t* in, int16_t* out, size_t frames)
+{
+	for (size_t i = 0; i < frames; ++i)
+		out[2 * i] = out[2 * i + 1] = in[i];
+}
+
+static void deinterleave_s16_scalar(const int16_t* in, float* left, float* right, size_t frames)
+{
+	for (size_t i = 0; i < frames; ++i)
+	{
+		left[i] = in[2 * i] * s16_inv_scale;
+		right[i] = in[2 * i + 1] * s16_inv_scale;
+	}
+}
+
+static void interleave_f32_scalar(const float* left, const float* right, float* out, size_t frames)
+{
+	for (size_t i = 0; i < frames; ++i)
+	{
+		out[2 * i] = left[i];
+		out[2 * i + 1] = right[i];
+	}
+}
+
+static void gain_f32_scalar(float* pcm, size_t count, float gain)
+{
+	for (size_t i = 0; i < count; ++i)
+	{
+		float v = pcm[i] * gain;
+		v = v > -1.0f ? v : -1.0f;
+		pcm[i] = v < 1.0f ? v : 1.0f;
+	}
+}
+
+static float dot_f32_scalar(const float* a, const float* b, size_t count)
+{
+	float sum = 0.0f;
+	for (size_t i = 0; i < count; ++i)
+		sum += a[i] * b[i];
+	return sum;
+}
+
+static void interleave_u8_scalar(const uint8_t* u, const uint8_t* v, uint8_t* out, size_t count)
+{
+	for (size_t i = 0; i < count; ++i)
+	{
+		out[2 * i] = u[i];
+		out[2 * i + 1] = v[i];
+	}
+}
+
+static void interleave_u16_scalar(const uint16_t* u, const uint16_t* v, uint16_t* out, size_t count, int shift)
+{
+	for (size_t i = 0; i < count; ++i)
+	{
+		out[2 * i] = static_cast<uint16_t>(u[i] << shift);
+		out[2 * i + 1] = static_cast<uint16_t>(v[i] << shift);
+	}
+}
+
+static void shl_u16_scalar(const uint16_t* in, uint16_t* out, size_t count, int shift)
+{
+	for (size_t i = 0; i < count; ++i)
+		out[i] = static_cast<uint16_t>(in[i] << shift);
+}
+
+static void u16_to_u8_scalar(const uint16_t* in, uint8_t* out, size_t count, int shift, const uint16_t* dither)
+{
+	for (size_t i = 0; i < count; ++i)
+	{
+		unsigned v = (in[i] + dither[i & 15u]) >> shift;
+		out[i] = static_cast<uint8_t>(v < 255 ? v : 255);
+	}
+}
+
+static void avg_rows_u8_scalar(const uint8_t* a, const uint8_t* b, uint8_t* out, size_t count)
+{
+	for (size_t i = 0; i < count; ++i)
+		out[i] = static_cast<uint8_t>((a[i] + b[i] + 1) >> 1);
+}
+
+static void avg_rows_u16_scalar(const uint16_t* a, const uint16_t* b, uint16_t* out, size_t count)
+{
+	for (size_t i = 0; i < count; ++i)
+		out[i] = static_cast<uint16_t>((a[i] + b[i] + 1) >> 1);
+}
+
+static void downsample_2x2_u8_scalar(const uint8_t* a, const uint8_t* b, uint8_t* out, size_t count)
+{
+	for (size_t i = 0; i < count; ++i)
+		out[i] = static_cast<uint8_t>((a[2 * i] + a[2 * i + 1] + b[2 * i] + b[2 * i + 1] + 2) >> 2);
+}
+
+static void downsample_2x2_u16_scalar(const uint16_t* a, const uint16_t* b, uint16_t* out, size_t count)
+{
+	for (size_t i = 0; i < count; ++i)
+		out[i] = static_cast<uint16_t>((a[2 * i] + a[2 * i + 1] + b[2 * i] + b[2 * i + 1] + 2) >> 2);
+}
+
+DSP_TARGET("sse2")
+static inline __m128i clamp_cvt_sse2(__m128 v)
+{
+	v = _mm_max_ps(v, _mm_set1_ps(-32768.0f));
+	v = _mm_min_ps(v, _mm_set1_ps(32767.0f));
+	return _mm_cvtps_epi32(v);
+}
+
+DSP_TARGET("sse2")
+static void gain_s16_sse2(int16_t* pcm, size_t count, float gain)
+{
+	__m128 g = _mm_set1_ps(gain);
+
+	size_t i = 0;
+	for (; i + 8 <= count; i += 8)
+	{
+		__m128i in = _mm_loadu_si128(reinterpret_cast<const __m128i*>(pcm + i));
+		__m128i lo = _mm_srai_epi32(_mm_unpacklo_epi16(in, in), 16);
+		__m128i hi = _mm_srai_epi32(_mm_unpackhi_epi16(in, in), 16);
+
+		lo = clamp_cvt_sse2(_mm_mul_ps(_mm_cvtepi32_ps(lo), g));
+		hi = clamp_cvt_sse2(_mm_mul_ps(_mm_cvtepi32_ps(hi), g));
+
+		_mm_storeu_si128(reinterpret_cast<__m128i*>(pcm + i), _mm_packs_epi32(lo, hi));
+	}
+
+	gain_s16_scalar(pcm + i, count - i, gain);
+}
+
+DSP_TARGET("sse2")
+static void f32_to_s16_sse2(const float* in, int16_t* out, size_t count)
+{
+	__m128 scale = _mm_set1_ps(s16_scale);
+
+	size_t i = 0;
+	for (; i + 8 <= count; i += 8)
+	{
+		__m128i lo = clamp_cvt_sse2(_mm_mul_ps(_mm_loadu_ps(in + i), scale));
+		__m128i hi = clamp_cvt_sse2(_mm_mul_ps(_mm_loadu_ps(in + i + 4), scale));
+		_mm_storeu_si128(reinterpret_cast<__m128i*>(out + i), _mm_packs_epi32(lo, hi));
+	}
+
+	f32_to_s16_scalar(in + i, out + i, count - i);
+}
+
+DSP_TARGET("sse2")
+static void downmix_s16_sse2(const int16_t* in, int16_t* out, size_t frames)
+{
+	__m128i ones = _mm_set1_epi16(1);
+
+	size_t i = 0;
+	for (; i + 8 <= frames; i += 8)
+	{
+		__m128i a = _mm_loadu_si128(reinterpret_cast<const __m128i*>(in + 2 * i));
+		__m128i b = _mm_loadu_si128(reinterpret_cast<const __m128i*>(in + 2 * i + 8));
+		a = _mm_srai_epi32(_mm_madd_epi16(a, ones), 1);
+		b = _mm_srai_epi32(_mm_madd_epi16(b, ones), 1);
+		_mm_storeu_si128(reinterpret_cast<__m128i*>(out + i), _mm_packs_epi32(a, b));
+	}
+
+	downmix_s16_scalar(in + 2 * i, out + i, frames - i);
+}
+
+DSP_TARGET("sse2")
+static void upmix_s16_sse2(const int16_t* in, int16_t* out, size_t frames)
+{
+	size_t i = 0;
+	for (; i + 8 <= frames; i += 8)
+	{
+		__m128i v = _mm_loadu_si128(reinterpret_cast<const __m128i*>(in + i));
+		_mm_storeu_si128(reinterpret_cast<__m128i*>(out + 2 * i), _mm_unpacklo_epi16(v, v));
+		_mm_storeu_si128(reinterpret_cast<__m128i*>(out + 2 * i + 8), _mm_unpackhi_epi16(v, v));
+	}
+
+	upmix_s16_scalar(in + i, out + 2 * i, frames - i);
+}
+
+DSP_TARGET("sse2")
+static void deinterleave_s16_sse2(const int16_t* in, float* left, float* right, size_t frames)
+{
+	__m128 scale = _mm_set1_ps(s16_inv_scale);
+
+	size_t i = 0;
+	for (; i + 4 <= frames; i += 4)
+	{
+		__m128i v = _mm_loadu_si128(reinterpret_cast<const __m128i*>(in + 2 * i));
+		__m128i l = _mm_srai_epi32(_mm_slli_epi32(v, 16), 16);
+		__m128i r = _mm_srai_epi32(v, 16);
+		_mm_storeu_ps(left + i, _mm_mul_ps(_mm_cvtepi32_ps(l), scale));
+		_mm_storeu_ps(right + i, _mm_mul_ps(_mm_cvtepi32_ps(r), scale));
+	}
+
+	deinterleave_s16_scalar(in + 2 * i, left + i, right + i, frames - i);
+}
+
+DSP_TARGET("sse2")
+static void interleave_f32_sse2(const float* left, const float* right, float* out, size_t frames)
+{
+	size_t i = 0;
+	for (; i + 4 <= frames; i += 4)
+	{
+		__m128 l = _mm_loadu_ps(left + i);
+		__m128 r = _mm_loadu_ps(right + i);
+		_mm_storeu_ps(out + 2 * i, _mm_unpacklo_ps(l, r));
+		_mm_storeu_ps(out + 2 * i + 4, _mm_unpackhi_ps(l, r));
+	}
+
+	interleave_f32_scalar(left + i, right + i, out + 2 * i, frames - i);
+}
+
+DSP_TARGET("sse2")
+static void gain_f32_sse2(float* pcm, size_t count, float gain)
+{
+	__m128 g = _mm_set1_ps(gain);
+	__m128 lo = _mm_set1_ps(-1.0f);
+	__m128 hi = _mm_set1_ps(1.0f);
+
+	size_t i = 0;
+	for (; i + 4 <= count; i += 4)
+	{
+		__m128 v = _mm_mul_ps(_mm_loadu_ps(pcm + i), g);
+		_mm_storeu_ps(pcm + i, _mm_min_ps(_mm_max_ps(v, lo), hi));
+	}
+
+	gain_f32_scalar(pcm + i, count - i, gain);
+}
+
+DSP_TARGET("sse2")
+static float dot_f32_sse2(const float* a, const float* b, size_t count)
+{
+	__m128 acc0 = _mm_setzero_ps();
+	__m128 acc1 = _mm_setzero_ps();
+
+	size_t i = 0;
+	for (; i + 8 <= count; i += 8)
+	{
+		acc0 = _mm_add_ps(acc0, _mm_mul_ps(_mm_loadu_ps(a + i), _mm_loadu_ps(b + i)));
+		acc1 = _mm_add_ps(acc1, _mm_mul_ps(_mm_loadu_ps(a + i + 4), _mm_loadu_ps(b + i + 4)));
+	}
+
+	__m128 acc = _mm_add_ps(acc0, acc1);
+	acc = _mm_add_ps(acc, _mm_movehl_ps(acc, acc));
+	acc = _mm_add_ss(acc, _mm_shuffle_ps(acc, acc, 1));
+	return _mm_cvtss_f32(acc) + dot_f32_scalar(a + i, b + i, count - i);
+}
+
+DSP_TARGET("sse2")
+static void interleave_u8_sse2(const uint8_t* u, const uint8_t* v, uint8_t* out, size_t count)
+{
+	size_t i = 0;
+	for (; i + 16 <= count; i += 16)
+	{
+		__m128i a = _mm_loadu_si128(reinterpret_cast<const __m128i*>(u + i));
+		__m128i b = _mm_loadu_si128(reinterpret_cast<const __m128i*>(v + i));
+		_mm_storeu_si128(reinterpret_cast<__m128i*>(out + 2 * i), _mm_unpacklo_epi8(a, b));
+		_mm_storeu_si128(reinterpret_cast<__m128i*>(out + 2 * i + 16), _mm_unpackhi_epi8(a, b));
+	}
+
+	interleave_u8_scalar(u + i, v + i, out + 2 * i, count - i);
+}
+
+DSP_TARGET("sse2")
+static void interleave_u16_sse2(const uint16_t* u, const uint16_t* v, uint16_t* out, size_t count, int shift)
+{
+	__m128i sh = _mm_cvtsi32_si128(shift);
+
+	size_t i = 0;
+	for (; i + 8 <= count; i += 8)
+	{
+		__m128i a = _mm_sll_epi16(_mm_loadu_si128(reinterpret_cast<const __m128i*>(u + i)), sh);
+		__m128i b = _mm_sll_epi16(_mm_loadu_si128(reinterpret_cast<const __m128i*>(v + i)), sh);
+		_mm_storeu_si128(reinterpret_cast<__m128i*>(out + 2 * i), _mm_unpacklo_epi16(a, b));
+		_mm_storeu_si128(reinterpret_cast<__m128i*>(out + 2 * i + 8), _mm_unpackhi_epi16(a, b));
+	}
+
+	interleave_u16_scalar(u + i, v + i, out + 2 * i, count - i, shift);
+}
+
+DSP_TARGET("sse2")
+static void shl_u16_sse2(const uint16_t* in, uint16_t* out, size_t count, int shift)
+{
+	__m128i sh = _mm_cvtsi32_si128(shift);
+
+	size_t i = 0;
+	for (; i + 8 <= count; i += 8)
+		_mm_storeu_si128(reinterpret_cast<__m128i*>(out + i), _mm_sll_epi16(_mm_loadu_si128(reinterpret_cast<const __m128i*>(in + i)), sh));
+
+	shl_u16_scalar(in + i, out + i, count - i, shift);
+}
+
+DSP_TARGET("sse2")
+static void u16_to_u8_sse2(const uint16_t* in, uint8_t* out, size_t count, int shift, const uint16_t* dither)
+{
+	__m128i sh = _mm_cvtsi32_si128(shift);
+	__m128i d0 = _mm_loadu_si128(reinterpret_cast<const __m128i*>(dither));
+	__m128i d1 = _mm_loadu_si128(reinterpret_cast<const __m128i*>(dither + 8));
+
+	size_t i = 0;
+	for (; i + 16 <= count; i += 16)
+	{
+		__m128i a = _mm_srl_epi16(_mm_adds_epu16(_mm_loadu_si128(reinterpret_cast<const __m128i*>(in + i)), d0), sh);
+		__m128i b = _mm_srl_epi16(_mm_adds_epu16(_mm_loadu_si128(reinterpret_cast<const __m128i*>(in + i + 8)), d1), sh);
+		_mm_storeu_si128(reinterpret_cast<__m128i*>(out + i), _mm_packus_epi16(a, b));
+	}
+
+	u16_to_u8_scalar(in + i, out + i, count - i, shift, dither);
+}
+
+DSP_TARGET("sse2")
+static void avg_rows_u8_sse2(const uint8_t* a, const uint8_t* b, uint8_t* out, size_t count)
+{
+	size_t i = 0;
+	for (; i + 16 <= count; i += 16)
+	{
+		__m128i x = _mm_loadu_si128(reinterpret_cast<const __m128i*>(a + i));
+		__m128i y = _mm_loadu_si128(reinterpret_cast<const __m128i*>(b + i));
+		_mm_storeu_si128(reinterpret_cast<__m128i*>(out + i), _mm_avg_epu8(x, y));
+	}
+
+	avg_rows_u8_scalar(a + i, b + i, out + i, count - i);
+}
+
+DSP_TARGET("sse2")
+static void avg_rows_u16_sse2(const uint16_t* a, const uint16_t* b, uint16_t* out, size_t count)
+{
+	size_t i = 0;
+	for (; i + 8 <= count; i += 8)
+	{
+		__m128i x = _mm_loadu_si128(reinterpret_cast<const __m128i*>(a + i));
+		__m128i y = _mm_loadu_si128(reinterpret_cast<const __m128i*>(b + i));
+		_mm_storeu_si128(reinterpret_cast<__m128i*>(out + i), _mm_avg_epu16(x, y));
+	}
+
+	avg_rows_u16_scalar(a + i, b + i, out + i, count - i);
+}
+
+// Horizontal pair sums of one 16-byte row, as eight u16 lanes.
+DSP_TARGET("sse2")
+static inline __m128i pair_sum_u8_sse2(__m128i v)
+{
+	return _mm_add_epi16(_mm_and_si128(v, _mm_set1_epi16(0xFF)), _mm_srli_epi16(v, 8));
+}
+
+DSP_TARGET("sse2")
+static void downsample_2x2_u8_sse2(const uint8_t* a, const uint8_t* b, uint8_t* out, size_t count)
+{
+	__m128i two = _mm_set1_epi16(2);
+
+	size_t i = 0;
+	for (; i + 16 <= count; i += 16)
+	{
+		__m128i lo = _mm_add_epi16(pair_sum_u8_sse2(_mm_loadu_si128(reinterpret_cast<const __m128i*>(a + 2 * i))),
+			pair_sum_u8_sse2(_mm_loadu_si128(reinterpret_cast<const __m128i*>(b + 2 * i))));
+		__m128i hi = _mm_add_epi16(pair_sum_u8_sse2(_mm_loadu_si128(reinterpret_cast<const __m128i*>(a + 2 * i + 16))),
+			pair_sum_u8_sse2(_mm_loadu_si128(reinterpret_cast<const __m128i*>(b + 2 * i + 16))));
+		lo = _mm_srli_epi16(_mm_add_epi16(lo, two), 2);
+		hi = _mm_srli_epi16(_mm_add_epi16(hi, two), 2);
+		_mm_storeu_si128(reinterpret_cast<__m128i*>(out + i), _mm_packus_epi16(lo, hi));
+	}
+
+	downsample_2x2_u8_scalar(a + 2 * i, b + 2 * i, out + i, count - i);
+}
+
+// Horizontal pair sums of one row of eight u16 samples, as four u32 lanes.
+DSP_TARGET("sse2")
+static inline __m128i pair_sum_u16_sse2(__m128i v)
+{
+	return _mm_add_epi32(_mm_and_si128(v, _mm_set1_epi32(0xFFFF)), _mm_srli_epi32(v, 16));
+}
+
+DSP_TARGET("sse2")
+static void downsample_2x2_u16_sse2(const uint16_t* a, const uint16_t* b, uint16_t* out, size_t count)
+{
+	__m128i two = _mm_set1_epi32(2);
+
+	size_t i = 0;
+	for (; i + 8 <= count; i += 8)
+	{
+		__m128i lo = _mm_add_epi32(pair_sum_u16_sse2(_mm_loadu_si128(reinterpret_cast<const __m128i*>(a + 2 * i))),
+			pair_sum_u16_sse2(_mm_loadu_si128(reinterpret_cast<const __m128i*>(b + 2 * i))));
+		__m128i hi = _mm_add_epi32(pair_sum_u16_sse2(_mm_loadu_si128(reinterpret_cast<const __m128i*>(a + 2 * i + 8))),
+			pair_sum_u16_sse2(_mm_loadu_si128(reinterpret_cast<const __m128i*>(b + 2 * i + 8))));
+		lo = _mm_srli_epi32(_mm_add_epi32(lo, two), 2);
+		hi = _mm_srli_epi32(_mm_add_epi32(hi, two), 2);
+
+		// SSE2 has no unsigned 32 -> 16 pack; the sums fit in 16 bits, so bias through the signed pack.
+		__m128i bias = _mm_set1_epi32(0x8000);
+		__m128i packed = _mm_packs_epi32(_mm_sub_epi32(lo, bias), _mm_sub_epi32(hi, bias));
+		_mm_storeu_si128(reinterpret_cast<__m128i*>(out + i), _mm_add_epi16(packed, _mm_set1_epi16(static_cast<short>(0x8000))));
+	}
+
+	downsample_2x2_u16_scalar(a + 2 * i, b + 2 * i, out + i, count - i);
+}
+
+DSP_TARGET("avx2")
+static inline __m256i clamp_cvt_avx2(__m256 v)
+{
+	v = _mm256_max_ps(v, _mm256_set1_ps(-32768.0f));
+	v = _mm256_min_ps(v, _mm256_set1_ps(32767.0f));
+	return _mm256_cvtps_epi32(v);
+}
+
+DSP_TARGET("avx2")
+static inline __m256i pack_s32_avx2(__m256i lo, __m256i hi)
+{
+	return _mm256_permute4x64_epi64(_mm256_packs_epi32(lo, hi), 0xD8);
+}
+
+DSP_TARGET("avx2")
+static void gain_s16_avx2(int16_t* pcm, size_t count, float gain)
+{
+	__m256 g = _mm256_set1_ps(gain);
+
+	size_t i = 0;
+	for (; i + 16 <= count; i += 16)
+	{
+		__m256i in = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(pcm + i));
+		__m256i lo = _mm256_cvtepi16_epi32(_mm256_castsi256_si128(in));
+		__m256i hi = _mm256_cvtepi16_epi32(_mm256_extracti128_si256(in, 1));
+
+		lo = clamp_cvt_avx2(_mm256_mul_ps(_mm256_cvtepi32_ps(lo), g));
+		hi = clamp_cvt_avx2(_mm256_mul_ps(_mm256_cvtepi32_ps(hi), g));
+
+		_mm256_storeu_si256(reinterpret_cast<__m256i*>(pcm + i), pack_s32_avx2(lo, hi));
+	}
+
+	gain_s16_sse2(pcm + i, count - i, gain);
+}
+
+DSP_TARGET("avx2")
+static void f32_to_s16_avx2(const float* in, int16_t* out, size_t count)
+{
+	__m256 scale = _mm256_set1_ps(s16_scale);
+
+	size_t i = 0;
+	for (; i + 16 <= count; i += 16)
+	{
+		__m256i lo = clamp_cvt_avx2(_mm256_mul_ps(_mm256_loadu_ps(in + i), scale));
+		__m256i hi = clamp_cvt_avx2(_mm256_mul_ps(_mm256_loadu_ps(in + i + 8), scale));
+		_mm256_storeu_si256(reinterpret_cast<__m256i*>(out + i), pack_s32_avx2(lo, hi));
+	}
+
+	f32_to_s16_sse2(in + i, out + i, count - i);
+}
+
+DSP_TARGET("avx2")
+static void downmix_s16_avx2(const int16_t* in, int16_t* out, size_t frames)
+{
+	__m256i ones = _mm256_set1_epi16(1);
+
+	size_t i = 0;
+	for (; i + 16 <= frames; i += 16)
+	{
+		__m256i a = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(in + 2 * i));
+		__m256i b = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(in + 2 * i + 16));
+		a = _mm256_srai_epi32(_mm256_madd_epi16(a, ones), 1);
+		b = _mm256_srai_epi32(_mm256_madd_epi16(b, ones), 1);
+		_mm256_storeu_si256(reinterpret_cast<__m256i*>(out + i), pack_s32_avx2(a, b));
+	}
+
+	downmix_s16_sse2(in + 2 * i, out + i, frames - i);
+}
+
+DSP_TARGET("avx2")
+static void upmix_s16_avx2(const int16_t* in, int16_t* out, size_t frames)
+{
+	size_t i = 0;
+	for (; i + 16 <= frames; i += 16)
+	{
+		__m256i v = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(in + i));
+		v = _mm256_permute4x64_epi64(v, 0xD8);
+		_mm256_storeu_si256(reinterpret_cast<__m256i*>(out + 2 * i), _mm256_unpacklo_epi16(v, v));
+		_mm256_storeu_si256(reinterpret_cast<__m256i*>(out + 2 * i + 16), _mm256_unpackhi_epi16(v, v));
+	}
+
+	upmix_s16_sse2(in + i, out + 2 * i, frames - i);
+}
+
+DSP_TARGET("avx2")
+static void deinterleave_s16_avx2(const int16_t* in, float* left, float* right, size_t frames)
+{
+	__m256 scale = _mm256_set1_ps(s16_inv_scale);
+
+	size_t i = 0;
+	for (; i + 8 <= frames; i += 8)
+	{
+		__m256i v = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(in + 2 * i));
+		__m256i l = _mm256_srai_epi32(_mm256_slli_epi32(v, 16), 16);
+		__m256i r = _mm256_srai_epi32(v, 16);
+		_mm256_storeu_ps(left + i, _mm256_mul_ps(_mm256_cvtepi32_ps(l), scale));
+		_mm256_storeu_ps(right + i, _mm256_mul_ps(_mm256_cvtepi32_ps(r), scale));
+	}
+
+	deinterleave_s16_sse2(in + 2 * i, left + i, right + i, frames - i);
+}
+
+DSP_TARGET("avx2")
+static void interleave_f32_avx2(const float* left, const float* right, float* out, size_t frames)
+{
+	size_t i = 0;
+	for (; i + 8 <= frames; i += 8)
+	{
+		__m256 l = _mm256_loadu_ps(left + i);
+		__m256 r = _mm256_loadu_ps(right + i);
+		__m256 lo = _mm256_unpacklo_ps(l, r);
+		__m256 hi = _mm256_unpackhi_ps(l, r);
+		_mm256_storeu_ps(out + 2 * i, _mm256_permute2f128_ps(lo, hi, 0x20));
+		_mm256_storeu_ps(out + 2 * i + 8, _mm256_permute2f128_ps(lo, hi, 0x31));
+	}
+
+	interleave_f32_sse2(left + i, right + i, out + 2 * i, frames - i);
+}
+
+DSP_TARGET("avx2")
+static void gain_f32_avx2(float* pcm, size_t count, float gain)
+{
+	__m256 g = _mm256_set1_ps(gain);
+	__m256 lo = _mm256_set1_ps(-1.0f);
+	__m256 hi = _mm256_set1_ps(1.0f);
+
+	size_t i = 0;
+	for (; i + 8 <= count; i += 8)
+	{
+		__m256 v = _mm256_mul_ps(_mm256_loadu_ps(pcm + i), g);
+		_mm256_storeu_ps(pcm + i, _mm256_min_ps(_mm256_max_ps(v, lo), hi));
+	}
+
+	gain_f32_sse2(pcm + i, count - i, gain);
+}
+
+DSP_TARGET("avx2,fma")
+static float dot_f32_avx2(const float* a, const float* b, size_t count)
+{
+	__m256 acc0 = _mm256_setzero_ps();
+	__m256 acc1 = _mm256_setzero_ps();
+
+	size_t i = 0;
+	for (; i + 16 <= count; i += 16)
+	{
+		acc0 = _mm256_fmadd_ps(_mm256_loadu_ps(a + i), _mm256_loadu_ps(b + i), acc0);
+		acc1 = _mm256_fmadd_ps(_mm256_loadu_ps(a + i + 8), _mm256_loadu_ps(b + i + 8), acc1);
+	}
+
+	__m256 acc = _mm256_add_ps(acc0, acc1);
+	__m128 sum = _mm_add_ps(_mm256_castps256_ps128(acc), _mm256_extractf128_ps(acc, 1));
+	sum = _mm_add_ps(sum, _mm_movehl_ps(sum, sum));
+	sum = _mm_add_ss(sum, _mm_shuffle_ps(sum, sum, 1));
+	return _mm_cvtss_f32(sum) + dot_f32_sse2(a + i, b + i, count - i);
+}
+
+DSP_TARGET("avx2")
+static void interleave_u8_avx2(const uint8_t* u, const uint8_t* v, uint8_t* out, size_t count)
+{
+	size_t i = 0;
+	for (; i + 32 <= count; i += 32)
+	{
+		__m256i a = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(u + i));
+		__m256i b = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(v + i));
+		__m256i lo = _mm256_unpacklo_epi8(a, b);
+		__m256i hi = _mm256_unpackhi_epi8(a, b);
+		_mm256_storeu_si256(reinterpret_cast<__m256i*>(out + 2 * i), _mm256_permute2x128_si256(lo, hi, 0x20));
+		_mm256_storeu_si256(reinterpret_cast<__m256i*>(out + 2 * i + 32), _mm256_permute2x128_si256(lo, hi, 0x31));
+	}
+
+	interleave_u8_sse2(u + i, v + i, out + 2 * i, count - i);
+}
+
+DSP_TARGET("avx2")
+static void interleave_u16_avx2(const uint16_t* u, const uint16_t* v, uint16_t* out, size_t count, int shift)
+{
+	__m128i sh = _mm_cvtsi32_si128(shift);
+
+	size_t i = 0;
+	for (; i + 16 <= count; i += 16)
+	{
+		__m256i a = _mm256_sll_epi16(_mm256_loadu_si256(reinterpret_cast<const __m256i*>(u + i)), sh);
+		__m256i b = _mm256_sll_epi16(_mm256_loadu_si256(reinterpret_cast<const __m256i*>(v + i)), sh);
+		__m256i lo = _mm256_unpacklo_epi16(a, b);
+		__m256i hi = _mm256_unpackhi_epi16(a, b);
+		_mm256_storeu_si256(reinterpret_cast<__m256i*>(out + 2 * i), _mm256_permute2x128_si256(lo, hi, 0x20));
+		_mm256_storeu_si256(reinterpret_cast<__m256i*>(out + 2 * i + 16), _mm256_permute2x128_si256(lo, hi, 0x31));
+	}
+
+	interleave_u16_sse2(u + i, v + i, out + 2 * i, count - i, shift);
+}
+
+DSP_TARGET("avx2")
+static void shl_u16_avx2(const uint16_t* in, uint16_t* out, size_t count, int shift)
+{
+	__m128i sh = _mm_cvtsi32_si128(shift);
+
+	size_t i = 0;
+	for (; i + 16 <= count; i += 16)
+		_mm256_storeu_si256(reinterpret_cast<__m256i*>(out + i), _mm256_sll_epi16(_mm256_loadu_si256(reinterpret_cast<const __m256i*>(in + i)), sh));
+
+	shl_u16_sse2(in + i, out + i, count - i, shift);
+}
+
+DSP_TARGET("avx2")
+static void u16_to_u8_avx2(const uint16_t* in, uint8_t* out, size_t count, int shift, const uint16_t* dither)
+{
+	__m128i sh = _mm_cvtsi32_si128(shift);
+	__m256i d = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(dither));
+
+	size_t i = 0;
+	for (; i + 32 <= count; i += 32)
+	{
+		__m256i a = _mm256_srl_epi16(_mm256_adds_epu16(_mm256_loadu_si256(reinterpret_cast<const __m256i*>(in + i)), d), sh);
+		__m256i b = _mm256_srl_epi16(_mm256_adds_epu16(_mm256_loadu_si256(reinterpret_cast<const __m256i*>(in + i + 16)), d), sh);
+		_mm256_storeu_si256(reinterpret_cast<__m256i*>(out + i), _mm256_permute4x64_epi64(_mm256_packus_epi16(a, b), 0xD8));
+	}
+
+	u16_to_u8_sse2(in + i, out + i, count - i, shift, dither);
+}
+
+DSP_TARGET("avx2")
+static void avg_rows_u8_avx2(const uint8_t* a, const uint8_t* b, uint8_t* out, size_t count)
+{
+	size_t i = 0;
+	for (; i + 32 <= count; i += 32)
+	{
+		__m256i x = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(a + i));
+		__m256i y = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(b + i));
+		_mm256_storeu_si256(reinterpret_cast<__m256i*>(out + i), _mm256_avg_epu8(x, y));
+	}
+
+	avg_rows_u8_sse2(a + i, b + i, out + i, count - i);
+}
+
+DSP_TARGET("avx2")
+static void avg_rows_u16_avx2(const uint16_t* a, const uint16_t* b, uint16_t* out, size_t count)
+{
+	size_t i = 0;
+	for (; i + 16 <= count; i += 16)
+	{
+		__m256i x = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(a + i));
+		__m256i y = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(b + i));
+		_mm256_storeu_si256(reinterpret_cast<__m256i*>(out + i), _mm256_avg_epu16(x, y));
+	}
+
+	avg_rows_u16_sse2(a + i, b + i, out + i, count - i);
+}
+
+DSP_TARGET("avx2")
+static void downsample_2x2_u8_avx2(const uint8_t* a, const uint8_t* b, uint8_t* out, size_t count)
+{
+	__m256i ones = _mm256_set1_epi8(1);
+	__m256i two = _mm256_set1_epi16(2);
+
+	size_t i = 0;
+	for (; i + 32 <= count; i += 32)
+	{
+		__m256i lo = _mm256_add_epi16(_mm256_maddubs_epi16(_mm256_loadu_si256(reinterpret_cast<const __m256i*>(a + 2 * i)), ones),
+			_mm256_maddubs_epi16(_mm256_loadu_si256(reinterpret_cast<const __m256i*>(b + 2 * i)), ones));
+		__m256i hi = _mm256_add_epi16(_mm256_maddubs_epi16(_mm256_loadu_si256(reinterpret_cast<const __m256i*>(a + 2 * i + 32)), ones),
+			_mm256_maddubs_epi16(_mm256_loadu_si256(reinterpret_cast<const __m256i*>(b + 2 * i + 32)), ones));
+		lo = _mm256_srli_epi16(_mm256_add_epi16(lo, two), 2);
+		hi = _mm256_srli_epi16(_mm256_add_epi16(hi, two), 2);
+		_mm256_storeu_si256(reinterpret_cast<__m256i*>(out + i), _mm256_permute4x64_epi64(_mm256_packus_epi16(lo, hi), 0xD8));
+	}
+
+	downsample_2x2_u8_sse2(a + 2 * i, b + 2 * i, out + i, count - i);
+}
+
+DSP_TARGET("avx2")
+static inline __m256i pair_sum_u16_avx2(const uint16_t* p)
+{
+	__m256i v = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(p));
+	return _mm256_add_epi32(_mm256_and_si256(v, _mm256_set1_epi32(0xFFFF)), _mm256_srli_epi32(v, 16));
+}
+
+DSP_TARGET("avx2")
+static void downsample_2x2_u16_avx2(const uint16_t* a, const uint16_t* b, uint16_t* out, size_t count)
+{
+	__m256i two = _mm256_set1_epi32(2);
+
+	size_t i = 0;
+	for (; i + 16 <= count; i += 16)
+	{
+		__m256i lo = _mm256_add_epi32(pair_sum_u16_avx2(a + 2 * i), pair_sum_u16_avx2(b + 2 * i));
+		__m256i hi = _mm256_add_epi32(pair_sum_u16_avx2(a + 2 * i + 16), pair_sum_u16_avx2(b + 2 * i + 16));
+		lo = _mm256_srli_epi32(_mm256_add_epi32(lo, two), 2);
+		hi = _mm256_srli_epi32(_mm256_add_epi32(hi, two), 2);
+		_mm256_storeu_si256(reinterpret_cast<__m256i*>(out + i), _mm256_permute4x64_epi64(_mm256_packus_epi32(lo, hi), 0xD8));
+	}
+
+	downsample_2x2_u16_sse2(a + 2 * i, b + 2 * i, out + i, count - i);
+}
+
+DSP_TARGET("avx512f")
+static inline __m256i clamp_cvt_avx512(__m512 v)
+{
+	v = _mm512_max_ps(v, _mm512_set1_ps(-32768.0f));
+	v = _mm512_min_ps(v, _mm512_set1_ps(32767.0f));
+	return _mm512_cvtepi32_epi16(_mm512_cvtps_epi32(v));
+}
+
+DSP_TARGET("avx512f")
+static void gain_s16_avx512(int16_t* pcm, size_t count, float gain)
+{
+	__m512 g = _mm512_set1_ps(gain);
+
+	size_t i = 0;
+	for (; i + 32 <= count; i += 32)
+	{
+		__m512i lo = _mm512_cvtepi16_epi32(_mm256_loadu_si256(reinterpret_cast<const __m256i*>(pcm + i)));
+		__m512i hi = _mm512_cvtepi16_epi32(_mm256_loadu_si256(reinterpret_cast<const __m256i*>(pcm + i + 16)));
+		_mm256_storeu_si256(reinterpret_cast<__m256i*>(pcm + i), clamp_cvt_avx512(_mm512_mul_ps(_mm512_cvtepi32_ps(lo), g)));
+		_mm256_storeu_si256(reinterpret_cast<__m256i*>(pcm + i + 16), clamp_cvt_avx512(_mm512_mul_ps(_mm512_cvtepi32_ps(hi), g)));
+	}
+
+	gain_s16_avx2(pcm + i, count - i, gain);
+}
+
+DSP_TARGET("avx512f")
+static void f32_to_s16_avx512(const float* in, int16_t* out, size_t count)
+{
+	__m512 scale = _mm512_set1_ps(s16_scale);
+
+	size_t i = 0;
+	for (; i + 32 <= count; i += 32)
+	{
+		_mm256_storeu_si256(reinterpret_cast<__m256i*>(out + i), clamp_cvt_avx512(_mm512_mul_ps(_mm512_loadu_ps(in + i), scale)));
+		_mm256_storeu_si256(reinterpret_cast<__m256i*>(out + i + 16), clamp_cvt_avx512(_mm512_mul_ps(_mm512_loadu_ps(in + i + 16), scale)));
+	}
+
+	f32_to_s16_avx2(in + i, out + i, count - i);
+}
+
+DSP_TARGET("avx512f")
+static void gain_f32_avx512(float* pcm, size_t count, float gain)
+{
+	__m512 g = _mm512_set1_ps(gain);
+	__m512 lo = _mm512_set1_ps(-1.0f);
+	__m512 hi = _mm512_set1_ps(1.0f);
+
+	size_t i = 0;
+	for (; i + 16 <= count; i += 16)
+	{
+		__m512 v = _mm512_mul_ps(_mm512_loadu_ps(pcm + i), g);
+		_mm512_storeu_ps(pcm + i, _mm512_min_ps(_mm512_max_ps(v, lo), hi));
+	}
+
+	gain_f32_avx2(pcm + i, count - i, gain);
+}
+
+DSP_TARGET("avx512f")
+static float dot_f32_avx512(const float* a, const float* b, size_t count)
+{
+	__m512 acc = _mm512_setzero_ps();
+
+	size_t i = 0;
+	for (; i + 16 <= count; i += 16)
+		acc = _mm512_fmadd_ps(_mm512_loadu_ps(a + i), _mm512_loadu_ps(b + i), acc);
+
+	return _mm512_reduce_add_ps(acc) + dot_f32_avx2(a + i, b + i, count - i);
+}
+
+static const dsp_t dsp_table[DSP_LEVELS] = {
+	{ "scalar", gain_s16_scalar, f32_to_s16_scalar, downmix_s16_scalar, upmix_s16_scalar, deinterleave_s16_scalar, interleave_f32_scalar, gain_f32_scalar, dot_f32_scalar, interleave_u8_scalar, interleave_u16_scalar, shl_u16_scalar, u16_to_u8_scalar, avg_rows_u8_scalar, avg_rows_u16_scalar, downsample_2x2_u8_scalar, downsample_2x2_u16_scalar },
+	{ "sse2", gain_s16_sse2, f32_to_s16_sse2, downmix_s16_sse2, upmix_s16_sse2, deinterleave_s16_sse2, interleave_f32_sse2, gain_f32_sse2, dot_f32_sse2, interleave_u8_sse2, interleave_u16_sse2, shl_u16_sse2, u16_to_u8_sse2, avg_rows_u8_sse2, avg_rows_u16_sse2, downsample_2x2_u8_sse2, downsample_2x2_u16_sse2 },
+	{ "avx2", gain_s16_avx2, f32_to_s16_avx2, downmix_s16_avx2, upmix_s16_avx2, deinterleave_s16_avx2, interleave_f32_avx2, gain_f32_avx2, dot_f32_avx2, interleave_u8_avx2, interleave_u16_avx2, shl_u16_avx2, u16_to_u8_avx2, avg_rows_u8_avx2, avg_rows_u16_avx2, downsample_2x2_u8_avx2, downsample_2x2_u16_avx2 },
+	{ "avx512", gain_s16_avx512, f32_to_s16_avx512, downmix_s16_avx2, upmix_s16_avx2, deinterleave_s16_avx2, interleave_f32_avx2, gain_f32_avx512, dot_f32_avx512, interleave_u8_avx2, interleave_u16_avx2, shl_u16_avx2, u16_to_u8_avx2, avg_rows_u8_avx2, avg_rows_u16_avx2, downsample_2x2_u8_avx2, downsample_2x2_u16_avx2 },
+};
+
+void deinterleave_s16(const int16_t* in, float* const* out, int channels, size_t frames)
+{
+	if (channels == 2)
+		return dsp().deinterleave_s16(in, out[0], out[1], frames);
+
+	for (size_t i = 0; i < frames; ++i)
+		for (int c = 0; c < channels; ++c)
+			out[c][i] = in[i * channels + c] * s16_inv_scale;
+}
+
+void interleave_f32(const float* const* in, float* out, int channels, size_t frames)
+{
+	if (channels == 2)
+		return dsp().interleave_f32(in[0], in[1], out, frames);
+
+	for (size_t i = 0; i < frames; ++i)
+		for (int c = 0; c < channels; ++c)
+			out[i * channels + c] = in[c][i];
+}
+
+size_t chroma_row_420(const uint8_t* src, int stride, int width, int rows, int sub_w, int sub_h, int bytes, int y, uint8_t* out)
+{
+	const dsp_t& k = dsp();
+
+	int r0 = sub_h == 2 ? y : std::min(2 * y, rows - 1);
+	int r1 = sub_h == 2 ? y : std::min(2 * y + 1, rows - 1);
+	const uint8_t* a = src + static_cast<size_t>(r0) * stride;
+	const uint8_t* b = src + static_cast<size_t>(r1) * stride;
+
+	if (sub_w == 2)
+	{
+		if (bytes == 1) k.avg_rows_u8(a, b, out, width);
+		else k.avg_rows_u16(reinterpret_cast<const uint16_t*>(a), reinterpret_cast<const uint16_t*>(b), reinterpret_cast<uint16_t*>(out), width);
+		return width;
+	}
+
+	size_t pairs = width / 2;
+	if (bytes == 1)
+	{
+		k.downsample_2x2_u8(a, b, out, pairs);
+		if (width & 1) out[pairs] = static_cast<uint8_t>((a[width - 1] + b[width - 1] + 1) >> 1);
+	}
+	else
+	{
+		auto* a16 = reinterpret_cast<const uint16_t*>(a);
+		auto* b16 = reinterpret_cast<const uint16_t*>(b);
+		auto* out16 = reinterpret_cast<uint16_t*>(out);
+		k.downsample_2x2_u16(a16, b16, out16, pairs);
+		if (width & 1) out16[pairs] = static_cast<uint16_t>((a16[width - 1] + b16[width - 1] + 1) >> 1);
+	}
+	return (width + 1) / 2;
+}
+
+dsp_level_t dsp_cpu_level()
+{
+#if defined(_MSC_VER) && !defined(__clang__)
+	int regs[4]{};
+	__cpuid(regs, 0);
+	int max_leaf = regs[0];
+
+	__cpuid(regs, 1);
+	bool sse2 = (regs[3] & (1 << 26)) != 0;
+	bool osxsave = (regs[2] & (1 << 27)) != 0;
+	bool avx = (regs[2] & (1 << 28)) != 0;
+	bool fma = (regs[2] & (1 << 12)) != 0;
+
+	unsigned long long xcr0 = osxsave ? _xgetbv(0) : 0;
+	bool ymm = (xcr0 & 0x6) == 0x6;
+	bool zmm = (xcr0 & 0xE6) == 0xE6;
+
+	bool avx2 = false, avx512 = false;
+	if (max_leaf >= 7)
+	{
+		__cpuidex(regs, 7, 0);
+		avx2 = (regs[1] & (1 << 5)) != 0;
+		avx512 = (regs[1] & (1 << 16)) != 0;
+	}
+
+	if (avx512 && fma && avx && zmm) return DSP_AVX512;
+	if (avx2 && fma && avx && ymm) return DSP_AVX2;
+	if (sse2) return DSP_SSE2;
+	return DSP_SCALAR;
+#else
+	__builtin_cpu_init();
+	bool fma = __builtin_cpu_supports("fma");
+	if (__builtin_cpu_supports("avx512f") && fma) return DSP_AVX512;
+	if (__builtin_cpu_supports("avx2") && fma) return DSP_AVX2;
+	if (__builtin_cpu_supports("sse2")) return DSP_SSE2;
+	return DSP_SCALAR;
+#endif
+}
+
+const dsp_t* dsp_kernels(dsp_level_t level)
+{
+	if (level < DSP_SCALAR || level >= DSP_LEVELS || level > dsp_cpu_level()) return 0;
+	return &dsp_table[level];
+}
+
+const dsp_t& dsp()
+{
+	static const dsp_t& selected = dsp_table[dsp_cpu_level()];
+	return selected;
+}
\ No newline at end of file
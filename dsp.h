@@ -0,0 +1,56 @@
+#pragma once
+#ifndef _DSP_H_
+#define _DSP_H_
+
+#include "include.h"
+
+enum dsp_level_t { DSP_SCALAR, DSP_SSE2, DSP_AVX2, DSP_AVX512, DSP_LEVELS };
+
+struct dsp_t
+{
+	const char* name = "";
+
+	// All s16 results are rounded to nearest and saturated; NaN maps to INT16_MIN.
+	void (*gain_s16)(int16_t* pcm, size_t count, float gain) = 0;
+	void (*f32_to_s16)(const float* in, int16_t* out, size_t count) = 0;
+
+	// Stereo <-> mono on interleaved s16; downmix is (l + r) >> 1.
+	void (*downmix_s16)(const int16_t* in, int16_t* out, size_t frames) = 0;
+	void (*upmix_s16)(const int16_t* in, int16_t* out, size_t frames) = 0;
+
+	// Interleaved stereo s16 <-> planar float in [-1, 1).
+	void (*deinterleave_s16)(const int16_t* in, float* left, float* right, size_t frames) = 0;
+	void (*interleave_f32)(const float* left, const float* right, float* out, size_t frames) = 0;
+
+	// In-place gain with the result clamped to [-1, 1]; NaN maps to -1.
+	void (*gain_f32)(float* pcm, size_t count, float gain) = 0;
+	float (*dot_f32)(const float* a, const float* b, size_t count) = 0;
+
+	// Two u8 planes into one interleaved plane, e.g. I420 chroma into an NV12 UV row.
+	void (*interleave_u8)(const uint8_t* u, const uint8_t* v, uint8_t* out, size_t count) = 0;
+	void (*interleave_u16)(const uint16_t* u, const uint16_t* v, uint16_t* out, size_t count, int shift) = 0;
+
+	// High-bit-depth samples: shift left into the MSBs (P010), or down to 8 bits.
+	// u16_to_u8 adds dither[i & 15] before the right shift and saturates; shift must be 1..8.
+	void (*shl_u16)(const uint16_t* in, uint16_t* out, size_t count, int shift) = 0;
+	void (*u16_to_u8)(const uint16_t* in, uint8_t* out, size_t count, int shift, const uint16_t* dither) = 0;
+
+	// Chroma subsampling to 4:2:0: average two rows (4:2:2), or 2x2 blocks (4:4:4, reads 2 * count per row).
+	void (*avg_rows_u8)(const uint8_t* a, const uint8_t* b, uint8_t* out, size_t count) = 0;
+	void (*avg_rows_u16)(const uint16_t* a, const uint16_t* b, uint16_t* out, size_t count) = 0;
+	void (*downsample_2x2_u8)(const uint8_t* a, const uint8_t* b, uint8_t* out, size_t count) = 0;
+	void (*downsample_2x2_u16)(const uint16_t* a, const uint16_t* b, uint16_t* out, size_t count) = 0;
+};
+
+void deinterleave_s16(const int16_t* in, float* const* out, int channels, size_t frames);
+void interleave_f32(const float* const* in, float* out, int channels, size_t frames);
+
+// Row y of the 4:2:0 chroma plane built from a plane subsampled by sub_w x sub_h (1 or 2);
+// width/rows are the source plane's, bytes is 1 or 2 per sample.
+size_t chroma_row_420(const uint8_t* src, int stride, int width, int rows, int sub_w, int sub_h, int bytes, int y, uint8_t* out);
+
+dsp_level_t dsp_cpu_level();
+const dsp_t* dsp_kernels(dsp_level_t level);
+const dsp_t& dsp();
+
+#endif
\ No newline at end of file
@@ -0,0 +1,172 @@
+#pragma once
+#ifndef _FRAMEPOOL_H_
+#define _FRAMEPOOL_H_
+
+#include "include.h"
+
+class frame_pool_t;
+
+struct frame_buffer_t
+{
+	frame_pool_t* pool = 0;
+	std::atomic<int> refs{ 0 };
+	size_t capacity = 0;
+	uint8_t* data = 0;
+};
+
+class frame_ref_t
+{
+public:
+	frame_ref_t() = default;
+	explicit frame_ref_t(frame_buffer_t* buf) : buf_(buf) { if (buf_) buf_->refs.fetch_add(1); }
+	~frame_ref_t() { reset(); }
+
+	frame_ref_t(const frame_ref_t&) = delete;
+	frame_ref_t& operator=(const frame_ref_t&) = delete;
+
+	frame_ref_t(frame_ref_t&& other) noexcept : buf_(other.buf_) { other.buf_ = 0; }
+	frame_ref_t& operator=(frame_ref_t&& other) noexcept
+	{
+		if (this != &other)
+		{
+			reset();
+			buf_ = other.buf_;
+			other.buf_ = 0;
+		}
+		return *this;
+	}
+
+	inline void reset();
+	frame_buffer_t* get() const { return buf_; }
+	explicit operator bool() const { return buf_ != 0; }
+
+private:
+	frame_buffer_t* buf_ = 0;
+};
+
+class frame_pool_t
+{
+public:
+	static constexpr size_t alignment = 64;
+	static constexpr size_t padding = 64;
+
+	frame_pool_t() = default;
+	~frame_pool_t()
+	{
+		for (auto& buf : all_)
+			::operator delete[](buf->data, std::align_val_t(alignment));
+	}
+
+	frame_pool_t(const frame_pool_t&) = delete;
+	frame_pool_t& operator=(const frame_pool_t&) = delete;
+
+	void attach(de265_decoder_context* decoder)
+	{
+		static de265_image_allocation allocation{ &frame_pool_t::get_buffer, &frame_pool_t::release_buffer };
+		de265_set_image_allocation_functions(decoder, &allocation, this);
+	}
+
+	frame_buffer_t* acquire(size_t size)
+	{
+		std::lock_guard<std::mutex> lock(mtx_);
+
+		for (size_t i = 0; i < free_.size(); ++i)
+		{
+			frame_buffer_t* buf = free_[i];
+			if (buf->capacity < size) continue;
+
+			free_[i] = free_.back();
+			free_.pop_back();
+			buf->refs.store(1);
+			return buf;
+		}
+
+		auto buf = std::make_unique<frame_buffer_t>();
+		buf->pool = this;
+		buf->capacity = size;
+		buf->data = static_cast<uint8_t*>(::operator new[](size, std::align_val_t(alignment)));
+		buf->refs.store(1);
+
+		all_.push_back(std::move(buf));
+		return all_.back().get();
+	}
+
+	void release(frame_buffer_t* buf)
+	{
+		if (buf->refs.fetch_sub(1) != 1) return;
+
+		std::lock_guard<std::mutex> lock(mtx_);
+		free_.push_back(buf);
+	}
+
+	size_t allocated() const
+	{
+		std::lock_guard<std::mutex> lock(mtx_);
+		return all_.size();
+	}
+
+private:
+	mutable std::mutex mtx_;
+	std::vector<std::unique_ptr<frame_buffer_t>> all_;
+	std::vector<frame_buffer_t*> free_;
+
+	static size_t align_up(size_t v, size_t a) { return (v + a - 1) / a * a; }
+
+	static int get_buffer(de265_decoder_context*, de265_image_spec* spec, de265_image* img, void* userdata)
+	{
+		auto* pool = static_cast<frame_pool_t*>(userdata);
+
+		int sub_w = 2, sub_h = 2, planes = 3;
+		switch (spec->format)
+		{
+		case de265_image_format_mono8: planes = 1; break;
+		case de265_image_format_YUV422P8: sub_h = 1; break;
+		case de265_image_format_YUV444P8: sub_w = 1; sub_h = 1; break;
+		default: break;
+		}
+
+		const size_t align = spec->alignment > 0 ? static_cast<size_t>(spec->alignment) : 16;
+
+		std::array<int, 3> strides{};
+		std::array<size_t, 3> offsets{};
+		size_t total = 0;
+
+		for (int c = 0; c < planes; ++c)
+		{
+			int w = c ? spec->width / sub_w : spec->width;
+			int h = c ? spec->height / sub_h : spec->height;
+			int bpp = (de265_get_bits_per_pixel(img, c) + 7) / 8;
+
+			strides[c] = static_cast<int>(align_up(w, align));
+			offsets[c] = total;
+			total += align_up(strides[c] * bpp * static_cast<size_t>(h) + padding, alignment);
+		}
+
+		frame_buffer_t* buf = pool->acquire(total);
+		if (!buf) return 0;
+
+		for (int c = 0; c < 3; ++c)
+		{
+			if (c < planes)
+				de265_set_image_plane(img, c, buf->data + offsets[c], strides[c], buf);
+			else
+				de265_set_image_plane(img, c, 0, 0, buf);
+		}
+
+		return 1;
+	}
+
+	static void release_buffer(de265_decoder_context*, de265_image* img, void*)
+	{
+		auto* buf = static_cast<frame_buffer_t*>(de265_get_image_plane_user_data(img, 0));
+		if (buf) buf->pool->release(buf);
+	}
+};
+
+inline void frame_ref_t::reset()
+{
+	if (buf_) buf_->pool->release(buf_);
+	buf_ = 0;
+}
+
+#endif
\ No newline at end of file
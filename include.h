@@ -1,34 +1,69 @@
-#pragma once
-#ifndef _INCLUDE_H_
-#define _INCLUDE_H_
-
-#include <fstream>
-#include <memory>
-#include <mutex>
-#include <queue>
-#include <chrono>
-#include <thread>
-#include <string>
-#include <array>
-#include <vector>
-#include <windows.h>
-
-#include <SDL3/SDL.h>
-#include <fdk-aac/aacdecoder_lib.h>
-#include <libde265/de265.h>
-
-#include "utils.h"
-#include "cryptor.h"
-#include "memstream.h"
-#include "player.h"
-
-#pragma comment(lib, "setupapi")
-#pragma comment(lib, "imm32")
-#pragma comment(lib, "version")
-#pragma comment(lib, "winmm")
-
-#pragma comment(lib, "fdk-aac")
-#pragma comment(lib, "libde265")
-#pragma comment(lib, "SDL3-static")
-
+#pragma once
+#ifndef _INCLUDE_H_
+#define _INCLUDE_H_
+
+#include <atomic>
+#include <condition_variable>
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <memory>
+#include <mutex>
+#include <queue>
+#include <chrono>
+#include <thread>
+#include <string>
+#include <algorithm>
+#include <array>
+#include <bit>
+#include <cmath>
+#include <span>
+#include <vector>
+
+#ifdef _WIN32
+#include <windows.h>
+#include <psapi.h>
+#endif
+
+#ifndef MPLAYER_HEADLESS
+#include <SDL3/SDL.h>
+#else
+typedef struct SDL_Window SDL_Window;
+typedef struct SDL_Renderer SDL_Renderer;
+typedef struct SDL_Texture SDL_Texture;
+typedef struct SDL_AudioStream SDL_AudioStream;
+#endif
+#include <fdk-aac/aacdecoder_lib.h>
+#include <libde265/de265.h>
+
+#include "utils.h"
+#include "platform.h"
+#include "cryptor.h"
+#include "memstream.h"
+#include "framepool.h"
+#include "dsp.h"
+#include "resampler.h"
+#include "trace.h"
+#include "clock.h"
+#include "telemetry.h"
+#include "player.h"
+#include "decode.h"
+
+// CMake builds link explicitly and define MPLAYER_NO_AUTOLINK.
+#if defined(_MSC_VER) && !defined(MPLAYER_NO_AUTOLINK)
+#pragma comment(lib, "fdk-aac")
+#pragma comment(lib, "libde265")
+#pragma comment(lib, "psapi")
+
+#ifndef MPLAYER_HEADLESS
+#pragma comment(lib, "setupapi")
+#pragma comment(lib, "imm32")
+#pragma comment(lib, "version")
+#pragma comment(lib, "winmm")
+#pragma comment(lib, "SDL3-static")
+#endif
+#endif
+
 #endif
\ No newline at end of file
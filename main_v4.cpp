@@ -1,642 +1,1356 @@
-#include "include.h"
-
-__forceinline void sleep_for(uint64_t ms)
-{
-	std::this_thread::sleep_for(std::chrono::milliseconds(ms));
-}
-uint64_t get_playback_time(player_t* mpctx)
-{
-	auto now = std::chrono::steady_clock::now();
-	auto delta = now - mpctx->base_clock;
-	return static_cast<uint64_t>(std::chrono::duration<double, std::milli>(delta).count());
-}
-
-void handle_seek(player_t* mpctx, int64_t delta_ms)
-{
-	if (!mpctx || !mpctx->video_track || !mpctx->audio_track) return;
-
-	mpctx->state.store(player_t::SEEKING);
-
-	int64_t current_time = static_cast<int64_t>(get_playback_time(mpctx));
-	int64_t target_time = std::max<int64_t>(0, current_time + delta_ms);
-	std::lock_guard<std::mutex> lock(mpctx->stream_mutex);
-
-	mpctx->video_frames.drain();
-	mpctx->audio_frames.drain();
-	mpctx->play_vframes.drain();
-	mpctx->play_aframes.drain();
-
-	const auto& v_samples = mpctx->video_track->samples;
-	const auto& a_samples = mpctx->audio_track->samples;
-
-	auto find_sample_idx = [](const std::vector<sample_t>& samples, uint64_t target_ms, uint32_t timescale) -> size_t {
-		if (samples.empty()) return 0;
-
-		uint64_t target_pts = static_cast<uint64_t>((target_ms / 1000.0) * timescale);
-		for (size_t i = samples.size(); i-- > 0;) {
-			if (samples[i].presentation_time <= target_pts)
-				return i;
-		}
-		return 0;
-		};
-
-	mpctx->v_idx.store(find_sample_idx(v_samples, target_time, mpctx->video_track->timescale));
-	mpctx->a_idx.store(find_sample_idx(a_samples, target_time, mpctx->audio_track->timescale));
-
-	sleep_for(1000);
-	mpctx->base_clock = std::chrono::steady_clock::now() - std::chrono::milliseconds(target_time);
-	mpctx->state.store(player_t::PLAYING);
-}
-
-void decode_video(player_t* mpctx)
-{
-	const auto& v_samples = mpctx->video_track->samples;
-
-	const uint8_t start_code[4] = { 0x00, 0x00, 0x00, 0x01 };
-
-	std::vector<uint8_t> hevc_init_nalus;
-	for (const auto& arr : mpctx->video_track->stsd->nal_units)
-	{
-		for (const auto& nal : arr)
-		{
-			hevc_init_nalus.insert(hevc_init_nalus.end(), start_code, start_code + 4);
-			hevc_init_nalus.insert(hevc_init_nalus.end(), nal.begin(), nal.end());
-		}
-	}
-
-	while (true)
-	{
-		auto state = mpctx->state.load();
-
-		if (state == player_t::STOPPED)
-			break;
-
-		static bool once = true;
-		if (state == player_t::PAUSED || state == player_t::SEEKING)
-		{ 
-			if (once) { printf("decode_video\n"); once = false; }
-			sleep_for(10);
-			continue;
-		}
-		once = true;
-
-		size_t idx = mpctx->v_idx.load();
-		if (idx >= v_samples.size())
-		{
-			sleep_for(10);
-			continue;
-		}
-
-		de265_decoder_context* decoder = de265_new_decoder();
-		if (!decoder)
-			continue;
-
-		de265_push_data(decoder, hevc_init_nalus.data(), hevc_init_nalus.size(), 0, 0);
-		de265_flush_data(decoder);
-
-		mpctx->dec_videof.store(false);
-
-		for (; idx < v_samples.size(); ++idx)
-		{
-			state = mpctx->state.load();
-			if (state == player_t::STOPPED || state == player_t::SEEKING)
-				break;
-
-			const auto& sample = v_samples[idx];
-			std::vector<uint8_t> data(sample.size);
-			{
-				std::lock_guard<std::mutex> lock(mpctx->stream_mutex);
-				mpctx->stream->seekg(sample.file_offset);
-				mpctx->stream->read(data.data(), data.size());
-			}
-
-			std::vector<uint8_t> annexb;
-			size_t pos = 0;
-			while (pos + 4 <= data.size())
-			{
-				state = mpctx->state.load();
-				if (state == player_t::STOPPED || state == player_t::SEEKING)
-					break;
-
-				uint32_t nal_len = (data[pos] << 24) | (data[pos + 1] << 16) | (data[pos + 2] << 8) | data[pos + 3];
-				pos += 4;
-				if (pos + nal_len > data.size()) break;
-				annexb.insert(annexb.end(), start_code, start_code + 4);
-				annexb.insert(annexb.end(), data.begin() + pos, data.begin() + pos + nal_len);
-				pos += nal_len;
-			}
-
-			uint64_t pts = (sample.decode_time + sample.composition_offset) * 1000 / mpctx->video_track->timescale;
-			de265_push_data(decoder, annexb.data(), annexb.size(), pts, 0);
-
-			de265_error err;
-			int more = 0;
-			do
-			{
-				state = mpctx->state.load();
-				if (state == player_t::STOPPED || state == player_t::SEEKING)
-					break;
-
-				err = de265_decode(decoder, &more);
-				if (!de265_isOK(err)) break;
-
-				const de265_image* img = 0;
-				while ((img = de265_get_next_picture(decoder)) != 0)
-				{
-					state = mpctx->state.load();
-					if (state == player_t::STOPPED || state == player_t::SEEKING)
-						break;
-
-					player_t::video_frame_t f{};
-					f.pts = de265_get_image_PTS(img);
-					f.width = de265_get_image_width(img, 0);
-					f.height = de265_get_image_height(img, 0);
-
-					for (int c = 0; c < 3; ++c)
-					{
-						int stride;
-						const uint8_t* plane = de265_get_image_plane(img, c, &stride);
-						int h = de265_get_image_height(img, c);
-						f.planes[c].assign(plane, plane + (stride * h));
-						f.strides[c] = stride;
-					}
-
-					mpctx->video_frames.push(std::move(f));
-				}
-
-			} while (more);
-
-			mpctx->v_idx.fetch_add(1);
-		}
-
-		mpctx->dec_videof.store(true);
-	}
-}
-
-void decode_audio(player_t* mpctx)
-{
-	const auto& a_samples = mpctx->audio_track->samples;
-
-	while (true)
-	{
-		auto state = mpctx->state.load();
-
-		if (state == player_t::STOPPED)
-			break;
-
-		static bool once = true;
-		if (state == player_t::PAUSED || state == player_t::SEEKING)
-		{
-			if (once) { printf("decode_audio\n"); once = false; }
-			sleep_for(10);
-			continue;
-		}
-		once = true;
-
-
-		size_t idx = mpctx->v_idx.load();
-		if (idx >= a_samples.size())
-		{
-			sleep_for(10);
-			continue;
-		}
-
-		HANDLE_AACDECODER aac_decoder = aacDecoder_Open(TT_MP4_RAW, 1);
-		if (!aac_decoder) continue;
-
-		{
-			auto& asc = mpctx->audio_track->stsd->asc_bytes;
-			auto ascLen = static_cast<UINT>(asc.size());
-			UCHAR* ascData = asc.data();
-			aacDecoder_ConfigRaw(aac_decoder, &ascData, &ascLen);
-		}
-
-		uint64_t decoded_sample_count = 0;
-
-		mpctx->dec_audiof.store(false);
-
-		for (; idx < a_samples.size(); ++idx)
-		{
-			state = mpctx->state.load();
-			if (state == player_t::STOPPED || state == player_t::SEEKING)
-				break;
-
-			const auto& sample = a_samples[idx];
-			std::vector<uint8_t> data(sample.size);
-			{
-				std::lock_guard<std::mutex> lock(mpctx->stream_mutex);
-				mpctx->stream->seekg(sample.file_offset);
-				mpctx->stream->read(data.data(), data.size());
-			}
-
-			UCHAR* ptr = data.data();
-			UINT buffer_size = data.size();
-			UINT bytes_valid = data.size();
-
-			if (aacDecoder_Fill(aac_decoder, &ptr, &buffer_size, &bytes_valid) == AAC_DEC_OK)
-			{
-				state = mpctx->state.load();
-				if (state == player_t::STOPPED || state == player_t::SEEKING)
-					break;
-
-				std::vector<int16_t> pcm(2048 * 2 * 2);
-				if (aacDecoder_DecodeFrame(aac_decoder, pcm.data(), pcm.size(), 0) == AAC_DEC_OK)
-				{
-					state = mpctx->state.load();
-					if (state == player_t::STOPPED || state == player_t::SEEKING)
-						break;
-
-					const CStreamInfo* info = aacDecoder_GetStreamInfo(aac_decoder);
-					if (info && info->sampleRate && info->numChannels)
-					{
-						state = mpctx->state.load();
-						if (state == player_t::STOPPED || state == player_t::SEEKING)
-							break;
-
-						pcm.resize(info->frameSize * info->numChannels);
-
-						player_t::audio_frame_t s{};
-						s.sample_rate = info->sampleRate;
-						s.channels = info->numChannels;
-						s.frame_size = info->frameSize;
-						s.pts = sample.decode_time * 1000ull / mpctx->audio_track->timescale;
-						s.pcm = std::move(pcm);
-
-						decoded_sample_count += info->frameSize;
-						mpctx->audio_frames.push(std::move(s));
-					}
-				}
-			}
-
-			mpctx->v_idx.fetch_add(1);
-		}
-
-		mpctx->dec_audiof.store(true);
-	}
-}
-
-void video_frame(player_t* mpctx)
-{
-	player_t::video_frame_t pending_frame{};
-	bool has_pending = false;
-
-	while (true)
-	{
-		auto state = mpctx->state.load();
-
-		if (state == player_t::STOPPED)
-			break;
-
-		static bool once = true;
-		if (state == player_t::PAUSED || state == player_t::SEEKING)
-		{
-			if (once) { printf("video_frame\n"); once = false; }
-			sleep_for(10);
-			continue;
-		}
-		once = true;
-
-
-		if (has_pending)
-		{
-			uint64_t now = get_playback_time(mpctx);
-			if (now >= pending_frame.pts)
-			{
-				mpctx->play_vframes.push(std::move(pending_frame));
-				has_pending = false;
-			}
-			else
-			{
-				auto wait_ms = std::min<uint64_t>((pending_frame.pts > now) ? (pending_frame.pts - now) : 0, 5);
-				sleep_for(wait_ms);
-				continue;
-			}
-		}
-		else
-		{
-			player_t::video_frame_t frame{};
-			if (mpctx->video_frames.pop(frame))
-			{
-				pending_frame = std::move(frame);
-				has_pending = true;
-			}
-			else
-			{
-				sleep_for(1);
-			}
-		}
-	}
-}
-
-void audio_frame(player_t* mpctx)
-{
-	player_t::audio_frame_t pending_frame{};
-	bool has_pending = false;
-
-	while (true)
-	{
-		auto state = mpctx->state.load();
-
-		if (state == player_t::STOPPED)
-			break;
-
-		static bool once = true;
-		if (state == player_t::PAUSED || state == player_t::SEEKING)
-		{
-			if (once) { printf("audio_frame\n"); once = false; }
-			sleep_for(10);
-			continue;
-		}
-		once = true;
-
-
-		if (has_pending)
-		{
-			uint64_t now = get_playback_time(mpctx);
-			if (now >= pending_frame.pts)
-			{
-				mpctx->play_aframes.push(std::move(pending_frame));
-				has_pending = false;
-			}
-			else
-			{
-				auto wait_ms = std::min<uint64_t>((pending_frame.pts > now) ? (pending_frame.pts - now) : 0, 5);
-				sleep_for(wait_ms);
-				continue;
-			}
-		}
-		else
-		{
-			player_t::audio_frame_t frame{};
-			if (mpctx->audio_frames.pop(frame))
-			{
-				pending_frame = std::move(frame);
-				has_pending = true;
-			}
-			else
-			{
-				sleep_for(1);
-			}
-		}
-	}
-}
-
-void play_vframe(player_t* mpctx)
-{
-	while (true)
-	{
-		auto state = mpctx->state.load();
-
-		if (state == player_t::STOPPED)
-			break;
-
-		static bool once = true;
-		if (state == player_t::PAUSED || state == player_t::SEEKING)
-		{
-			if (once) { printf("player_video_frame\n"); once = false; }
-			sleep_for(10);
-			continue;
-		}
-		once = true;
-
-		printf("pop_begin\n");
-		player_t::video_frame_t frame{};
-		if (!mpctx->play_vframes.pop(frame)) continue;
-		printf("pop_end\n");
-
-		SDL_UpdateYUVTexture(mpctx->texture, 0,
-			frame.planes[0].data(), frame.strides[0],
-			frame.planes[1].data(), frame.strides[1],
-			frame.planes[2].data(), frame.strides[2]);
-
-		SDL_RenderClear(mpctx->renderer);
-		SDL_RenderTexture(mpctx->renderer, mpctx->texture, 0, 0);
-		SDL_RenderPresent(mpctx->renderer);
-	}
-}
-
-void play_aframe(player_t* mpctx)
-{
-	while (true)
-	{
-		auto state = mpctx->state.load();
-
-		if (state == player_t::STOPPED)
-			break;
-
-		static bool once = true;
-		if (state == player_t::PAUSED || state == player_t::SEEKING)
-		{
-			if (once) { printf("player_audio_frame\n"); once = false; }
-			sleep_for(10);
-			continue;
-		}
-		once = true;
-
-		player_t::audio_frame_t frame{};
-		if (!mpctx->play_aframes.pop(frame)) continue;
-
-		float volume = mpctx->volume.load();
-		if (volume == 0.0f)
-		{
-			std::this_thread::sleep_for(std::chrono::milliseconds(10));
-			continue;
-		}
-
-		int16_t* pcm = frame.pcm.data();
-		size_t count = frame.pcm.size();
-
-		if (volume != 1.0f)
-		{
-			__m256 vVolume = _mm256_set1_ps(volume);
-			__m256i vMin = _mm256_set1_epi32(INT16_MIN);
-			__m256i vMax = _mm256_set1_epi32(INT16_MAX);
-
-			size_t i = 0;
-			for (; i + 15 < count; i += 16)
-			{
-				__m256i in = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(pcm + i));
-
-				__m128i inLo = _mm256_extracti128_si256(in, 0);
-				__m128i inHi = _mm256_extracti128_si256(in, 1);
-
-				__m256i inLo32 = _mm256_cvtepi16_epi32(inLo);
-				__m256i inHi32 = _mm256_cvtepi16_epi32(inHi);
-
-				__m256 fLo = _mm256_cvtepi32_ps(inLo32);
-				__m256 fHi = _mm256_cvtepi32_ps(inHi32);
-
-				fLo = _mm256_mul_ps(fLo, vVolume);
-				fHi = _mm256_mul_ps(fHi, vVolume);
-
-				__m256i sLo32 = _mm256_cvtps_epi32(fLo);
-				__m256i sHi32 = _mm256_cvtps_epi32(fHi);
-
-				sLo32 = _mm256_max_epi32(vMin, _mm256_min_epi32(vMax, sLo32));
-				sHi32 = _mm256_max_epi32(vMin, _mm256_min_epi32(vMax, sHi32));
-
-				__m128i packedLo = _mm_packs_epi32(
-					_mm256_extracti128_si256(sLo32, 0),
-					_mm256_extracti128_si256(sLo32, 1)
-				);
-
-				__m128i packedHi = _mm_packs_epi32(
-					_mm256_extracti128_si256(sHi32, 0),
-					_mm256_extracti128_si256(sHi32, 1)
-				);
-
-				__m256i result = _mm256_insertf128_si256(_mm256_castsi128_si256(packedLo), (packedHi), 0x1);
-				_mm256_storeu_si256(reinterpret_cast<__m256i*>(pcm + i), result);
-			}
-
-			for (; i < count; ++i)
-			{
-				int sample = static_cast<int>(pcm[i] * volume);
-				pcm[i] = static_cast<int16_t>(std::max(std::min(sample, static_cast<int>(INT16_MAX)), static_cast<int>(INT16_MIN)));
-			}
-		}
-
-		SDL_PutAudioStreamData(mpctx->audio_stream, pcm, static_cast<int>(count * sizeof(int16_t)));
-	}
-}
-
-int wmain(int argc, wchar_t** argv)
-{
-	std::vector<char> password{ 'z', '1', 'x', '2', 'c', '3', 'v', '4', 'b', '5', 'n', '6' };
-	std::wstring filepath = L"C:\\C\\1_x265_enc.mp4";
-
-	std::unique_ptr<player_t> mpctx = std::make_unique<player_t>();
-	player_t* ptrmpctx = mpctx.get();
-
-	mpctx->stream = std::make_unique<memstream_t>(filepath, password);
-	if (!mpctx->stream->is_valid()) return 4;
-
-	mpctx->mp4 = std::make_unique<mp4_t>();
-	if (!mpctx->mp4->parse(mpctx->stream.get())) return 5;
-
-	for (const auto& track : mpctx->mp4->_tracks)
-	{
-		if (!mpctx->video_track && track.type == 'vide') mpctx->video_track = &track;
-		if (!mpctx->audio_track && track.type == 'soun') mpctx->audio_track = &track;
-	}
-
-	if (!mpctx->video_track || !mpctx->audio_track)
-		return 6;
-
-	if (mpctx->video_track && mpctx->video_track->stsd->nal_units.empty())
-		return 7;
-
-	if (mpctx->audio_track && mpctx->audio_track->stsd->asc_bytes.empty())
-		return 8;
-
-	{
-		if (SDL_Init(SDL_INIT_VIDEO | SDL_INIT_AUDIO) < 0) return 6;
-
-		mpctx->window = SDL_CreateWindow("playa", mpctx->video_track->width / 1.5, mpctx->video_track->height / 1.5, SDL_WINDOW_RESIZABLE);
-		if (!mpctx->window) return 8;
-
-		mpctx->renderer = SDL_CreateRenderer(mpctx->window, 0);
-		if (!mpctx->renderer) return 9;
-
-		mpctx->texture = SDL_CreateTexture(mpctx->renderer, SDL_PIXELFORMAT_IYUV, SDL_TEXTUREACCESS_STREAMING, mpctx->video_track->width, mpctx->video_track->height);
-		if (!mpctx->texture) return 10;
-
-		SDL_AudioSpec audio_spec{};
-		audio_spec.freq = mpctx->audio_track->sample_rate;
-		audio_spec.channels = mpctx->audio_track->channel_count;
-		audio_spec.format = SDL_AUDIO_S16; // mpctx->audio_track->sample_size
-
-		mpctx->audio_stream = SDL_OpenAudioDeviceStream(SDL_AUDIO_DEVICE_DEFAULT_PLAYBACK, &audio_spec, 0, 0);
-		if (!mpctx->audio_stream)
-			return 11;
-
-		SDL_ResumeAudioStreamDevice(mpctx->audio_stream);
-	}
-
-	mpctx->state.store(player_t::PLAYING);
-	mpctx->base_clock = std::chrono::steady_clock::now();
-
-	std::jthread(decode_video, ptrmpctx).detach();
-	std::jthread(decode_audio, ptrmpctx).detach();
-	std::jthread(video_frame, ptrmpctx).detach();
-	std::jthread(audio_frame, ptrmpctx).detach();
-	std::jthread(play_vframe, ptrmpctx).detach();
-	std::jthread(play_aframe, ptrmpctx).detach();
-
-	button_t ck_quit('Q', 10);
-	button_t ck_pause(VK_SPACE, 150);
-	button_t ck_vup(VK_UP, 100);
-	button_t ck_vdown(VK_DOWN, 100);
-	button_t ck_lseek(VK_LEFT, 300);
-	button_t ck_rseek(VK_RIGHT, 300);
-
-	while (mpctx->state.load() != player_t::STOPPED)
-	{
-		if (ck_quit.is_pressed())
-		{
-			mpctx->state.store(player_t::STOPPED);
-		}
-
-		if (ck_pause.is_pressed())
-		{
-			auto state = mpctx->state.load();
-
-			if (state == player_t::PLAYING)
-			{
-				mpctx->pause_time = std::chrono::steady_clock::now();
-				mpctx->state.store(player_t::PAUSED);
-			}
-			else if (state == player_t::PAUSED)
-			{
-				auto resume_time = std::chrono::steady_clock::now();
-				auto paused_duration = resume_time - mpctx->pause_time;
-				mpctx->base_clock += paused_duration;
-				mpctx->state.store(player_t::PLAYING);
-			}
-		}
-
-		if (ck_vup.is_pressed())
-		{
-			float v = mpctx->volume.load();
-			if (v < 3.0f) mpctx->volume.store(v + 0.1f);
-		}
-
-		if (ck_vdown.is_pressed())
-		{
-			float v = mpctx->volume.load();
-			if (v > 0.0f) mpctx->volume.store(v - 0.1f);
-		}
-
-		if (ck_lseek.is_pressed())
-		{
-			handle_seek(ptrmpctx, -1000);
-		}
-
-		if (ck_rseek.is_pressed())
-		{
-			handle_seek(ptrmpctx, +1000);
-		}
-
-		SDL_Event e;
-		while (SDL_PollEvent(&e))
-		{
-			switch (e.type)
-			{
-			case SDL_EVENT_QUIT:
-				mpctx->state.store(player_t::STOPPED);
-				break;
-			case SDL_EVENT_WINDOW_MOVED:
-			case SDL_EVENT_WINDOW_RESIZED:
-			case SDL_EVENT_WINDOW_PIXEL_SIZE_CHANGED:
-			case SDL_EVENT_WINDOW_RESTORED:
-				break;
-			}
-		}
-
-		sleep_for(10);
-	}
-
-	SDL_Quit();
-
-	return 0;
+#include "include.h"
+
+int64_t audio_queued_us(player_t* mpctx)
+{
+	if (mpctx->audio_bytes_per_sec <= 0) return 0;
+	int queued = SDL_GetAudioStreamQueued(mpctx->audio_stream);
+	return std::max(queued, 0) * 1000000ll / mpctx->audio_bytes_per_sec;
+}
+
+// Follows the audio device: the end of the last submitted sample, less what is still queued and the device latency.
+// Once there is no audio left to follow (no audio track, or its end has played out) media time carries on from the
+// last audio position on the wall clock, so video running past the audio still reaches its deadlines.
+class realtime_clock_t : public playback_clock_t
+{
+public:
+	explicit realtime_clock_t(player_t* mpctx) : mpctx_(mpctx) {}
+
+	bool realtime() const override { return true; }
+
+	int64_t now_us() override
+	{
+		int64_t base = mpctx_->clock_base_us.load();
+		int64_t end = mpctx_->audio_end_us.load();
+		int64_t queued = audio_queued_us(mpctx_);
+
+		int64_t played = end < 0 ? base : std::max(end - queued - mpctx_->audio_latency_us, base);
+
+		bool audio_done = mpctx_->dec_audiof.load() && mpctx_->pcm_chunks.size() == 0 && queued == 0;
+		if (!audio_done)
+		{
+			extrapolating_.store(false);
+			return played;
+		}
+
+		return wall_us(played);
+	}
+
+	int64_t until_us(int64_t pts_us) override { return pts_us - now_us(); }
+
+	void reset(int64_t base_us) override
+	{
+		mpctx_->audio_end_us.store(-1);
+		mpctx_->clock_base_us.store(base_us);
+		extrapolating_.store(false);
+	}
+
+private:
+	// Advances only while playing, so a pause holds media time where it was.
+	int64_t wall_us(int64_t from_us)
+	{
+		std::lock_guard<std::mutex> lock(wall_mtx_);
+
+		auto now = std::chrono::steady_clock::now();
+		if (!extrapolating_.exchange(true))
+		{
+			wall_us_ = from_us;
+			wall_at_ = now;
+		}
+
+		if (mpctx_->state.load() == player_t::PLAYING)
+			wall_us_ += std::chrono::duration_cast<std::chrono::microseconds>(now - wall_at_).count();
+		wall_us_ = std::max(wall_us_, from_us);
+		wall_at_ = now;
+
+		return wall_us_;
+	}
+
+	player_t* mpctx_;
+
+	std::mutex wall_mtx_;
+	std::atomic<bool> extrapolating_{ false };
+	int64_t wall_us_ = 0;
+	std::chrono::steady_clock::time_point wall_at_;
+};
+
+int64_t get_playback_us(player_t* mpctx)
+{
+	return mpctx->clock->now_us();
+}
+
+uint64_t get_playback_time(player_t* mpctx)
+{
+	return static_cast<uint64_t>(get_playback_us(mpctx) / 1000);
+}
+
+void update_refresh_rate(player_t* mpctx)
+{
+	const SDL_DisplayMode* mode = SDL_GetCurrentDisplayMode(SDL_GetDisplayForWindow(mpctx->window));
+	if (mode && mode->refresh_rate > 0.0f)
+		mpctx->refresh_us.store(static_cast<int64_t>(1000000.0 / mode->refresh_rate));
+	else
+		mpctx->refresh_us.store(0);
+}
+
+void spin_until(std::chrono::steady_clock::time_point deadline)
+{
+	while (std::chrono::steady_clock::now() < deadline)
+		std::this_thread::yield();
+}
+
+void handle_seek(player_t* mpctx, int64_t delta_ms)
+{
+	if (!mpctx) return;
+
+	int64_t current_time = static_cast<int64_t>(get_playback_time(mpctx));
+
+	auto find_sample_idx = [](const std::vector<sample_t>& samples, uint64_t target_ms, uint32_t timescale) -> size_t {
+		if (samples.empty()) return 0;
+
+		uint64_t target_pts = static_cast<uint64_t>((target_ms / 1000.0) * timescale);
+		for (size_t i = samples.size(); i-- > 0;) {
+			if (samples[i].presentation_time <= target_pts)
+				return i;
+		}
+		return 0;
+		};
+
+	size_t item = 0, v_idx = 0, a_idx = 0;
+	int64_t target_time = 0;
+	{
+		std::lock_guard<std::mutex> lock(mpctx->state_mtx);
+
+		const player_t::media_t* m = 0;
+		for (size_t i = 0; i < mpctx->media.size(); ++i)
+		{
+			const auto& cur = mpctx->media[i];
+			if (!cur || !cur->video_track) continue;
+			if (static_cast<int64_t>(cur->offset_ms) > current_time) break;
+			m = cur.get();
+			item = i;
+		}
+		if (!m) return;
+
+		int64_t begin = static_cast<int64_t>(m->offset_ms);
+		int64_t end = begin + std::max<int64_t>(1, m->duration_ms);
+		target_time = std::clamp<int64_t>(current_time + delta_ms, begin, end - 1);
+
+		uint64_t local = static_cast<uint64_t>(target_time - begin);
+		v_idx = find_sample_idx(m->video_track->samples, local, m->video_track->timescale);
+		if (m->audio_track)
+			a_idx = find_sample_idx(m->audio_track->samples, local, m->audio_track->timescale);
+	}
+
+	trace_scope_t trace("seek");
+	mpctx->set_state(player_t::SEEKING);
+
+	mpctx->video_frames.drain();
+	mpctx->pcm.wake();
+
+	mpctx->start_item.store(item);
+	mpctx->v_idx.store(v_idx);
+	mpctx->a_idx.store(a_idx);
+
+	{
+		trace_scope_t lock_trace("seek audio lock");
+		SDL_LockAudioStream(mpctx->audio_stream);
+		SDL_ClearAudioStream(mpctx->audio_stream);
+		mpctx->clock->reset(target_time * 1000);
+		mpctx->serial.fetch_add(1);
+		SDL_UnlockAudioStream(mpctx->audio_stream);
+	}
+
+	SDL_ResumeAudioStreamDevice(mpctx->audio_stream);
+	mpctx->set_state(player_t::PLAYING);
+}
+
+int load_media(player_t* mpctx, const std::filesystem::path& path, player_t::media_t& m)
+{
+	m.path = path;
+
+	m.stream = std::make_unique<memstream_t>(path, mpctx->password);
+	if (!m.stream->is_valid()) return 4;
+
+	m.mp4 = std::make_unique<mp4_t>();
+	if (!m.mp4->parse(m.stream.get())) return 5;
+
+	for (const auto& track : m.mp4->_tracks)
+	{
+		if (!m.video_track && track.type == 'vide') m.video_track = &track;
+		if (!m.audio_track && track.type == 'soun') m.audio_track = &track;
+	}
+
+	if (!m.video_track)
+		return 6;
+
+	if (m.video_track->stsd->nal_units.empty())
+		return 7;
+
+	if (m.audio_track && m.audio_track->stsd->asc_bytes.empty())
+		return 8;
+
+	auto track_end_ms = [](const track_t* track) -> uint64_t {
+		if (track->samples.empty() || !track->timescale) return 0;
+		const auto& last = track->samples.back();
+		return (static_cast<uint64_t>(last.decode_time) + last.duration) * 1000 / track->timescale;
+		};
+
+	m.duration_ms = m.audio_track ? track_end_ms(m.audio_track) : 0;
+	if (!m.duration_ms)
+		m.duration_ms = track_end_ms(m.video_track);
+
+	return 0;
+}
+
+void prime_media(player_t* mpctx, player_t::media_t* m)
+{
+	const auto& samples = m->video_track->samples;
+
+	de265_decoder_context* decoder = open_video_decoder(mpctx, m->video_track);
+	if (!decoder)
+		return;
+
+	size_t idx = 0;
+	for (; idx < samples.size() && m->primed_frames.size() < player_t::prime_frames; ++idx)
+	{
+		if (idx > 0 && samples[idx].is_keyframe)
+			break;
+
+		push_video_sample(decoder, m, idx);
+
+		int more = 0;
+		do
+		{
+			if (!de265_isOK(de265_decode(decoder, &more))) break;
+
+			player_t::video_frame_t f;
+			while (m->primed_frames.size() < player_t::prime_frames && pull_video_frame(decoder, f))
+				m->primed_frames.push_back(std::move(f));
+
+		} while (more && m->primed_frames.size() < player_t::prime_frames);
+	}
+
+	m->primed_decoder = decoder;
+	m->primed_next = idx;
+}
+
+void preload_media(player_t* mpctx)
+{
+	g_trace()->name_thread("preload");
+
+	uint64_t offset = 0;
+	{
+		std::lock_guard<std::mutex> lock(mpctx->state_mtx);
+		offset = mpctx->media[0]->offset_ms + mpctx->media[0]->duration_ms;
+	}
+
+	for (size_t next = 1; next < mpctx->playlist.size(); ++next)
+	{
+		mpctx->wait_state([&]()
+			{
+				return mpctx->state.load() == player_t::STOPPED || std::max(mpctx->v_item.load(), mpctx->a_item.load()) + 1 >= next;
+			});
+		if (mpctx->state.load() == player_t::STOPPED)
+			break;
+
+		auto start_time = std::chrono::steady_clock::now();
+		trace_scope_t trace("preload item");
+
+		auto m = std::make_unique<player_t::media_t>();
+		int err = load_media(mpctx, mpctx->playlist[next], *m);
+		if (err)
+		{
+			printf("preload: item %zu failed (%d)\n", next, err);
+			m->video_track = m->audio_track = 0;
+			m->duration_ms = 0;
+		}
+		else
+		{
+			prime_media(mpctx, m.get());
+		}
+
+		m->offset_ms = offset;
+		offset += m->duration_ms;
+
+		printf("preload: item %zu ready in %.1f ms, %zu frames primed\n", next,
+			std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start_time).count(),
+			m->primed_frames.size());
+
+		std::vector<std::unique_ptr<player_t::media_t>> expired;
+		{
+			std::lock_guard<std::mutex> lock(mpctx->state_mtx);
+			mpctx->media[next] = std::move(m);
+
+			size_t in_use = std::min(mpctx->v_item.load(), mpctx->a_item.load());
+			for (size_t i = 0; i + 1 < in_use; ++i)
+			{
+				if (mpctx->media[i])
+					expired.push_back(std::move(mpctx->media[i]));
+			}
+		}
+		mpctx->state_cv.notify_all();
+	}
+}
+
+void decode_video_item(player_t* mpctx, player_t::media_t* m, size_t idx, uint32_t serial)
+{
+	const auto& v_samples = m->video_track->samples;
+	const uint64_t offset = m->offset_ms;
+
+	auto emit = [&](player_t::video_frame_t&& f, de265_decoder_context* decoder) {
+		f.pts += offset;
+		f.serial = serial;
+
+		if (mpctx->clock->realtime())
+		{
+			int64_t lead = static_cast<int64_t>(f.pts) - static_cast<int64_t>(get_playback_time(mpctx));
+			mpctx->overload.update(decoder, lead);
+		}
+
+		mpctx->decoded_vframes.fetch_add(1);
+
+		stage_timer_t timer(mpctx->telemetry, telemetry_t::STAGE_VQUEUE_PUSH);
+		mpctx->video_frames.push(std::move(f));
+		};
+
+	de265_decoder_context* decoder = 0;
+	std::vector<player_t::video_frame_t> primed;
+	uint64_t pushed_samples = 0;
+
+	if (idx == 0 && m->primed_decoder)
+	{
+		decoder = m->primed_decoder;
+		m->primed_decoder = 0;
+		primed.swap(m->primed_frames);
+		idx = pushed_samples = m->primed_next;
+	}
+	else
+	{
+		decoder = open_video_decoder(mpctx, m->video_track);
+	}
+
+	if (!decoder)
+		return;
+
+	mpctx->overload.attach(decoder);
+
+	mpctx->dec_videof.store(false);
+
+	auto start_time = std::chrono::steady_clock::now();
+	uint64_t start_frames = mpctx->decoded_vframes.load();
+
+	for (auto& f : primed)
+	{
+		if (mpctx->interrupted(serial))
+			break;
+		emit(std::move(f), decoder);
+	}
+	primed.clear();
+
+	for (; idx < v_samples.size(); ++idx)
+	{
+		if (mpctx->interrupted(serial))
+			break;
+
+		{
+			stage_timer_t timer(mpctx->telemetry, telemetry_t::STAGE_READ);
+			push_video_sample(decoder, m, idx);
+		}
+		++pushed_samples;
+
+		de265_error err;
+		int more = 0;
+		do
+		{
+			if (mpctx->interrupted(serial))
+				break;
+
+			{
+				stage_timer_t timer(mpctx->telemetry, telemetry_t::STAGE_DECODE);
+				err = de265_decode(decoder, &more);
+			}
+			if (!de265_isOK(err)) break;
+
+			player_t::video_frame_t f;
+			while (pull_video_frame(decoder, f))
+			{
+				if (mpctx->interrupted(serial))
+					break;
+
+				emit(std::move(f), decoder);
+			}
+
+		} while (more);
+	}
+
+	de265_free_decoder(decoder);
+
+	auto elapsed = std::chrono::duration<double>(std::chrono::steady_clock::now() - start_time).count();
+	uint64_t frames = mpctx->decoded_vframes.load() - start_frames;
+	if (pushed_samples > frames)
+		mpctx->overload.skipped.fetch_add(pushed_samples - frames);
+
+	if (elapsed > 0.0)
+		printf("decode_video: %llu frames, %.1f fps, %d threads, ratio %d%%, skipped %llu, dropped %llu\n",
+			static_cast<unsigned long long>(frames), frames / elapsed, mpctx->decoder_threads,
+			mpctx->overload.ratio.load(),
+			static_cast<unsigned long long>(mpctx->overload.skipped.load()),
+			static_cast<unsigned long long>(mpctx->overload.dropped.load()));
+
+	mpctx->dec_videof.store(true);
+}
+
+void decode_video(player_t* mpctx)
+{
+	g_trace()->name_thread("decode_video");
+
+	while (mpctx->wait_runnable() != player_t::STOPPED)
+	{
+		uint32_t serial = mpctx->serial.load();
+		size_t item = mpctx->start_item.load();
+		size_t idx = mpctx->v_idx.load();
+
+		for (;; ++item, idx = 0)
+		{
+			player_t::media_t* m = mpctx->wait_media(item, serial);
+			if (!m)
+			{
+				if (item >= mpctx->media.size())
+				{
+					mpctx->eof_serial.store(serial);
+					mpctx->video_frames.wake_consumer();
+				}
+				break;
+			}
+
+			mpctx->enter_item(mpctx->v_item, item);
+			if (!m->video_track)
+				continue;
+
+			decode_video_item(mpctx, m, idx, serial);
+			if (mpctx->interrupted(serial))
+				break;
+		}
+
+		mpctx->wait_serial(serial);
+	}
+}
+
+void decode_audio_item(player_t* mpctx, player_t::media_t* m, size_t idx, uint32_t serial, audio_sink_t& sink)
+{
+	const auto& a_samples = m->audio_track->samples;
+
+	HANDLE_AACDECODER aac_decoder = open_audio_decoder(m->audio_track);
+	if (!aac_decoder) return;
+
+	std::vector<int16_t> pcm(player_t::pcm_chunk_t::max_samples);
+
+	for (; idx < a_samples.size(); ++idx)
+	{
+		if (mpctx->interrupted(serial))
+			break;
+
+		const CStreamInfo* info = decode_audio_sample(mpctx, aac_decoder, m, idx, pcm);
+		if (!info)
+			continue;
+
+		const auto& sample = a_samples[idx];
+		uint64_t pts = m->offset_ms + sample.decode_time * 1000ull / m->audio_track->timescale;
+		if (!sink.push(mpctx, pcm.data(), info, pts, serial))
+			break;
+	}
+
+	aacDecoder_Close(aac_decoder);
+}
+
+void decode_audio(player_t* mpctx)
+{
+	g_trace()->name_thread("decode_audio");
+
+	while (mpctx->wait_runnable() != player_t::STOPPED)
+	{
+		uint32_t serial = mpctx->serial.load();
+		size_t item = mpctx->start_item.load();
+		size_t idx = mpctx->a_idx.load();
+
+		audio_sink_t sink;
+
+		mpctx->dec_audiof.store(false);
+
+		for (;; ++item, idx = 0)
+		{
+			player_t::media_t* m = mpctx->wait_media(item, serial);
+			if (!m)
+				break;
+
+			mpctx->enter_item(mpctx->a_item, item);
+			if (!m->audio_track)
+				continue;
+
+			decode_audio_item(mpctx, m, idx, serial, sink);
+			if (mpctx->interrupted(serial))
+				break;
+		}
+
+		mpctx->dec_audiof.store(true);
+		mpctx->wait_serial(serial);
+	}
+}
+
+bool renderer_supports(SDL_Renderer* renderer, SDL_PixelFormat format)
+{
+	auto* formats = static_cast<const SDL_PixelFormat*>(SDL_GetPointerProperty(SDL_GetRendererProperties(renderer), SDL_PROP_RENDERER_TEXTURE_FORMATS_POINTER, 0));
+	for (; formats && *formats != SDL_PIXELFORMAT_UNKNOWN; ++formats)
+	{
+		if (*formats == format) return true;
+	}
+	return false;
+}
+
+bool create_textures(player_t* mpctx, int width, int height, player_t::texture_kind_t kind)
+{
+	static const SDL_PixelFormat formats[] = { SDL_PIXELFORMAT_IYUV, SDL_PIXELFORMAT_NV12, SDL_PIXELFORMAT_P010 };
+
+	mpctx->texture_w = 0;
+	mpctx->texture_h = 0;
+	mpctx->texture_idx = 0;
+
+	for (auto& texture : mpctx->textures)
+	{
+		SDL_DestroyTexture(texture);
+		texture = SDL_CreateTexture(mpctx->renderer, formats[kind], SDL_TEXTUREACCESS_STREAMING, width, height);
+		if (!texture) return false;
+	}
+
+	mpctx->texture_w = width;
+	mpctx->texture_h = height;
+	mpctx->texture_kind = kind;
+	return true;
+}
+
+player_t::texture_kind_t texture_kind_for(const player_t* mpctx, int bit_depth)
+{
+	if (bit_depth > 8 && mpctx->p010_supported) return player_t::TEXTURE_P010;
+	if (mpctx->nv12_supported) return player_t::TEXTURE_NV12;
+	return player_t::TEXTURE_IYUV;
+}
+
+void copy_plane(uint8_t* dst, int dst_pitch, const uint8_t* src, int src_stride, int width, int rows)
+{
+	if (dst_pitch == src_stride)
+	{
+		memcpy(dst, src, static_cast<size_t>(src_stride) * rows);
+		return;
+	}
+
+	for (int y = 0; y < rows; ++y)
+		memcpy(dst + static_cast<size_t>(y) * dst_pitch, src + static_cast<size_t>(y) * src_stride, width);
+}
+
+// 8x8 ordered dither, scaled per row to the number of bits being dropped.
+void dither_row(uint16_t* row, int y, int shift)
+{
+	static const uint8_t bayer[8][8] = {
+		{ 0, 32, 8, 40, 2, 34, 10, 42 },
+		{ 48, 16, 56, 24, 50, 18, 58, 26 },
+		{ 12, 44, 4, 36, 14, 46, 6, 38 },
+		{ 60, 28, 52, 20, 62, 30, 54, 22 },
+		{ 3, 35, 11, 43, 1, 33, 9, 41 },
+		{ 51, 19, 59, 27, 49, 17, 57, 25 },
+		{ 15, 47, 7, 39, 13, 45, 5, 37 },
+		{ 63, 31, 55, 23, 61, 29, 53, 21 },
+	};
+
+	for (int x = 0; x < 16; ++x)
+		row[x] = static_cast<uint16_t>((bayer[y & 7][x & 7] << shift) >> 6);
+}
+
+void convert_row(const uint8_t* src, uint8_t* dst, int width, int bit_depth, int y)
+{
+	if (bit_depth <= 8)
+	{
+		memcpy(dst, src, width);
+		return;
+	}
+
+	int shift = std::min(bit_depth - 8, 8);
+	uint16_t dither[16];
+	dither_row(dither, y, shift);
+	dsp().u16_to_u8(reinterpret_cast<const uint16_t*>(src), dst, width, shift, dither);
+}
+
+void convert_plane(uint8_t* dst, int dst_pitch, const uint8_t* src, int src_stride, int width, int rows, int bit_depth)
+{
+	if (bit_depth <= 8)
+		return copy_plane(dst, dst_pitch, src, src_stride, width, rows);
+
+	for (int y = 0; y < rows; ++y)
+		convert_row(src + static_cast<size_t>(y) * src_stride, dst + static_cast<size_t>(y) * dst_pitch, width, bit_depth, y);
+}
+
+SDL_Texture* upload_frame(player_t* mpctx, const player_t::video_frame_t& frame)
+{
+	auto kind = texture_kind_for(mpctx, frame.bit_depth);
+	if (frame.width != mpctx->texture_w || frame.height != mpctx->texture_h || kind != mpctx->texture_kind)
+	{
+		if (!create_textures(mpctx, frame.width, frame.height, kind)) return 0;
+	}
+
+	SDL_Texture* texture = mpctx->textures[mpctx->texture_idx];
+	mpctx->texture_idx = (mpctx->texture_idx + 1) % player_t::texture_count;
+
+	void* pixels = 0;
+	int pitch = 0;
+	if (!SDL_LockTexture(texture, 0, &pixels, &pitch)) return 0;
+
+	const dsp_t& k = dsp();
+	int depth = frame.bit_depth;
+	int bytes = depth > 8 ? 2 : 1;
+	int chroma_w = (frame.width + 1) / 2;
+	int chroma_h = (frame.height + 1) / 2;
+
+	// Rows 0-1: U/V reduced to 4:2:0, rows 2-3: U/V reduced to 8 bits, row 4: neutral chroma for mono.
+	size_t scratch_row = static_cast<size_t>(chroma_w) * 2;
+	auto& scratch = mpctx->upload_scratch;
+	if (scratch.size() < scratch_row * 5)
+		scratch.resize(scratch_row * 5);
+
+	if (frame.chroma == de265_chroma_mono)
+	{
+		uint8_t* grey = scratch.data() + scratch_row * 4;
+		if (bytes == 1)
+			std::fill_n(grey, chroma_w, uint8_t(128));
+		else
+			std::fill_n(reinterpret_cast<uint16_t*>(grey), chroma_w, static_cast<uint16_t>(1u << (depth - 1)));
+	}
+
+	auto row = [&](int c, int y) { return frame.planes[c] + static_cast<size_t>(y) * frame.strides[c]; };
+
+	auto chroma_row = [&](int c, int y) -> const uint8_t*
+		{
+			switch (frame.chroma)
+			{
+			case de265_chroma_mono:
+				return scratch.data() + scratch_row * 4;
+			case de265_chroma_422:
+			case de265_chroma_444:
+			{
+				uint8_t* out = scratch.data() + scratch_row * (c - 1);
+				int sub_w = frame.chroma == de265_chroma_422 ? 2 : 1;
+				chroma_row_420(frame.planes[c], frame.strides[c], frame.chroma == de265_chroma_422 ? chroma_w : frame.width,
+					frame.height, sub_w, 1, bytes, y, out);
+				return out;
+			}
+			default:
+				return row(c, y);
+			}
+		};
+
+	uint8_t* dst = static_cast<uint8_t*>(pixels);
+
+	if (kind == player_t::TEXTURE_P010)
+	{
+		int shift = 16 - std::min(depth, 16);
+		int uv_pitch = (pitch + 3) / 4 * 4;
+
+		for (int y = 0; y < frame.height; ++y)
+			k.shl_u16(reinterpret_cast<const uint16_t*>(row(0, y)), reinterpret_cast<uint16_t*>(dst + static_cast<size_t>(y) * pitch), frame.width, shift);
+		dst += static_cast<size_t>(pitch) * frame.height;
+
+		for (int y = 0; y < chroma_h; ++y)
+		{
+			k.interleave_u16(reinterpret_cast<const uint16_t*>(chroma_row(1, y)), reinterpret_cast<const uint16_t*>(chroma_row(2, y)),
+				reinterpret_cast<uint16_t*>(dst + static_cast<size_t>(y) * uv_pitch), chroma_w, shift);
+		}
+	}
+	else if (kind == player_t::TEXTURE_NV12)
+	{
+		int uv_pitch = (pitch + 1) / 2 * 2;
+
+		convert_plane(dst, pitch, frame.planes[0], frame.strides[0], frame.width, frame.height, depth);
+		dst += static_cast<size_t>(pitch) * frame.height;
+
+		for (int y = 0; y < chroma_h; ++y)
+		{
+			const uint8_t* u = chroma_row(1, y);
+			const uint8_t* v = chroma_row(2, y);
+			if (depth > 8)
+			{
+				uint8_t* u8 = scratch.data() + scratch_row * 2;
+				uint8_t* v8 = scratch.data() + scratch_row * 3;
+				convert_row(u, u8, chroma_w, depth, y);
+				convert_row(v, v8, chroma_w, depth, y);
+				u = u8;
+				v = v8;
+			}
+			k.interleave_u8(u, v, dst + static_cast<size_t>(y) * uv_pitch, chroma_w);
+		}
+	}
+	else
+	{
+		int uv_pitch = (pitch + 1) / 2;
+
+		convert_plane(dst, pitch, frame.planes[0], frame.strides[0], frame.width, frame.height, depth);
+		dst += static_cast<size_t>(pitch) * frame.height;
+
+		if (frame.chroma == de265_chroma_420)
+		{
+			convert_plane(dst, uv_pitch, frame.planes[1], frame.strides[1], chroma_w, chroma_h, depth);
+			convert_plane(dst + static_cast<size_t>(uv_pitch) * chroma_h, uv_pitch, frame.planes[2], frame.strides[2], chroma_w, chroma_h, depth);
+		}
+		else
+		{
+			for (int c = 1; c <= 2; ++c)
+			{
+				uint8_t* plane = dst + static_cast<size_t>(uv_pitch) * chroma_h * (c - 1);
+				for (int y = 0; y < chroma_h; ++y)
+					convert_row(chroma_row(c, y), plane + static_cast<size_t>(y) * uv_pitch, chroma_w, depth, y);
+			}
+		}
+	}
+
+	SDL_UnlockTexture(texture);
+	return texture;
+}
+
+// Counters drawn over the video; rates are resampled every half second so they stay readable.
+struct overlay_t
+{
+	static constexpr auto interval = std::chrono::milliseconds(500);
+
+	bool visible = false;
+	int64_t drift_us = 0;
+
+	std::chrono::steady_clock::time_point sampled_at{};
+	uint64_t decoded = 0;
+	uint64_t presented = 0;
+	double decode_fps = 0.0;
+	double present_fps = 0.0;
+	double memory_mb = 0.0;
+};
+
+void sample_overlay(player_t* mpctx, overlay_t& overlay)
+{
+	auto now = std::chrono::steady_clock::now();
+	if (now - overlay.sampled_at < overlay_t::interval) return;
+
+	double elapsed = std::chrono::duration<double>(now - overlay.sampled_at).count();
+	uint64_t decoded = mpctx->decoded_vframes.load();
+	uint64_t presented = mpctx->present_stats.count;
+
+	if (overlay.sampled_at != std::chrono::steady_clock::time_point{})
+	{
+		overlay.decode_fps = (decoded - overlay.decoded) / elapsed;
+		overlay.present_fps = (presented - overlay.presented) / elapsed;
+	}
+
+	overlay.sampled_at = now;
+	overlay.decoded = decoded;
+	overlay.presented = presented;
+	overlay.memory_mb = working_set_mb();
+}
+
+void draw_overlay(player_t* mpctx, overlay_t& overlay)
+{
+	sample_overlay(mpctx, overlay);
+
+	constexpr int line_count = 6;
+	char lines[line_count][96];
+	snprintf(lines[0], sizeof(lines[0]), "decode  %5.1f fps   present %5.1f fps",
+		overlay.decode_fps, overlay.present_fps);
+	snprintf(lines[1], sizeof(lines[1]), "dropped %llu   skipped %llu   late %llu",
+		static_cast<unsigned long long>(mpctx->overload.dropped.load()),
+		static_cast<unsigned long long>(mpctx->overload.skipped.load()),
+		static_cast<unsigned long long>(mpctx->telemetry.late.load()));
+	snprintf(lines[2], sizeof(lines[2]), "a/v     %+6.1f ms   refresh %.1f ms",
+		overlay.drift_us / 1000.0, mpctx->refresh_us.load() / 1000.0);
+	snprintf(lines[3], sizeof(lines[3]), "queues  video %zu   pcm %zu   audio %lld ms",
+		mpctx->video_frames.size(), mpctx->pcm_chunks.size(), static_cast<long long>(audio_queued_us(mpctx) / 1000));
+	snprintf(lines[4], sizeof(lines[4]), "decoder %d threads   ratio %d%%",
+		mpctx->decoder_threads, mpctx->overload.ratio.load());
+	snprintf(lines[5], sizeof(lines[5]), "memory  %.0f MB   frame pool %zu",
+		overlay.memory_mb, mpctx->vframe_pool.allocated());
+
+	int output_h = 0;
+	SDL_GetRenderOutputSize(mpctx->renderer, 0, &output_h);
+	float scale = static_cast<float>(std::max(1, output_h / 540));
+
+	const float glyph = SDL_DEBUG_TEXT_FONT_CHARACTER_SIZE;
+	const float margin = glyph / 2;
+	const float line_h = glyph + 2;
+	SDL_FRect panel{ 0, 0, margin * 2 + glyph * 44, margin * 2 + line_h * line_count };
+
+	SDL_SetRenderScale(mpctx->renderer, scale, scale);
+	SDL_SetRenderDrawBlendMode(mpctx->renderer, SDL_BLENDMODE_BLEND);
+	SDL_SetRenderDrawColor(mpctx->renderer, 0, 0, 0, 160);
+	SDL_RenderFillRect(mpctx->renderer, &panel);
+
+	SDL_SetRenderDrawColor(mpctx->renderer, 255, 255, 255, 255);
+	for (int i = 0; i < line_count; ++i)
+		SDL_RenderDebugText(mpctx->renderer, margin, margin + line_h * i, lines[i]);
+
+	SDL_SetRenderDrawColor(mpctx->renderer, 0, 0, 0, 255);
+	SDL_SetRenderScale(mpctx->renderer, 1.0f, 1.0f);
+}
+
+void draw_frame(player_t* mpctx, SDL_Texture* texture, overlay_t& overlay)
+{
+	SDL_RenderClear(mpctx->renderer);
+	SDL_RenderTexture(mpctx->renderer, texture, 0, 0);
+	if (overlay.visible)
+		draw_overlay(mpctx, overlay);
+}
+
+int open_renderer(player_t* mpctx, int width, int height, bool force_iyuv)
+{
+	mpctx->renderer = SDL_CreateRenderer(mpctx->window, 0);
+	if (!mpctx->renderer) return 9;
+
+	if (mpctx->clock->realtime())
+		mpctx->vsync = SDL_SetRenderVSync(mpctx->renderer, 1);
+
+	mpctx->nv12_supported = !force_iyuv && renderer_supports(mpctx->renderer, SDL_PIXELFORMAT_NV12);
+	mpctx->p010_supported = !force_iyuv && renderer_supports(mpctx->renderer, SDL_PIXELFORMAT_P010);
+	if (!create_textures(mpctx, width, height, texture_kind_for(mpctx, 8))) return 10;
+
+	printf("texture: %s%s x%zu\n", mpctx->nv12_supported ? "nv12" : "iyuv", mpctx->p010_supported ? ", p010" : "", player_t::texture_count);
+	return 0;
+}
+
+void close_renderer(player_t* mpctx)
+{
+	for (auto& texture : mpctx->textures)
+	{
+		SDL_DestroyTexture(texture);
+		texture = 0;
+	}
+
+	SDL_DestroyRenderer(mpctx->renderer);
+	mpctx->renderer = 0;
+}
+
+void play_vframe(player_t* mpctx, int width, int height, bool force_iyuv)
+{
+	g_trace()->name_thread("render");
+
+	int err = open_renderer(mpctx, width, height, force_iyuv);
+	{
+		std::lock_guard<std::mutex> lock(mpctx->state_mtx);
+		mpctx->render_status.store(err ? -err : 1);
+	}
+	mpctx->state_cv.notify_all();
+
+	if (err)
+	{
+		close_renderer(mpctx);
+		return;
+	}
+
+	player_t::video_frame_t frame{};
+	bool has_pending = false;
+	bool uploaded = false;
+	int64_t last_present_us = INT64_MIN / 2;
+
+	SDL_Texture* shown = 0;
+	SDL_Texture* staged = 0;
+	auto staged_at = std::chrono::steady_clock::now();
+
+	auto& telemetry = mpctx->telemetry;
+	overlay_t overlay;
+
+	auto has_commands = [&]() { return mpctx->render_cmds.size() > 0; };
+
+	// Only the virtual clock ends the run: there is no one watching, so stop once the last frame is out.
+	auto finished = [&]()
+		{
+			return !mpctx->clock->realtime() && mpctx->eof_serial.load() == mpctx->serial.load() && mpctx->video_frames.size() == 0;
+		};
+
+	auto run_commands = [&]()
+		{
+			player_t::render_cmd_t cmd;
+			bool redraw = false;
+			while (mpctx->render_cmds.try_pop(cmd))
+			{
+				if (cmd == player_t::RENDER_OVERLAY)
+					overlay.visible = !overlay.visible;
+				redraw |= cmd != player_t::RENDER_NONE;
+			}
+
+			if (!redraw || !shown)
+				return;
+
+			draw_frame(mpctx, shown, overlay);
+			SDL_RenderPresent(mpctx->renderer);
+
+			if (uploaded)
+				draw_frame(mpctx, staged, overlay);
+		};
+
+	while (true)
+	{
+		mpctx->wait_state([&]()
+			{
+				auto s = mpctx->state.load();
+				return s == player_t::PLAYING || s == player_t::STOPPED || has_commands();
+			});
+		if (mpctx->state.load() == player_t::STOPPED)
+			break;
+
+		run_commands();
+		if (mpctx->state.load() != player_t::PLAYING)
+			continue;
+
+		if (!has_pending)
+		{
+			{
+				stage_timer_t timer(telemetry, telemetry_t::STAGE_VQUEUE_POP);
+				if (!mpctx->video_frames.pop(frame, [&]() { return has_commands() || finished(); }))
+				{
+					if (finished())
+					{
+						mpctx->set_state(player_t::STOPPED);
+
+						SDL_Event quit{};
+						quit.type = SDL_EVENT_QUIT;
+						SDL_PushEvent(&quit);
+					}
+					continue;
+				}
+			}
+			telemetry.depths[telemetry_t::DEPTH_VIDEO_FRAMES].record(mpctx->video_frames.size());
+			has_pending = true;
+			uploaded = false;
+		}
+
+		if (frame.serial != mpctx->serial.load())
+		{
+			frame = {};
+			has_pending = false;
+			continue;
+		}
+
+		int64_t pts_us = static_cast<int64_t>(frame.pts) * 1000;
+		int64_t now_us = get_playback_us(mpctx);
+		int64_t refresh = mpctx->refresh_us.load();
+
+		bool late = now_us > pts_us + player_t::overload_t::late_drop_ms * 1000;
+		if (late && now_us < last_present_us + player_t::overload_t::min_present_ms * 1000)
+		{
+			mpctx->overload.dropped.fetch_add(1);
+			frame = {};
+			has_pending = false;
+			continue;
+		}
+
+		if (!uploaded)
+		{
+			if (frame.width != mpctx->texture_w || frame.height != mpctx->texture_h || texture_kind_for(mpctx, frame.bit_depth) != mpctx->texture_kind)
+				shown = 0;
+
+			{
+				stage_timer_t timer(telemetry, telemetry_t::STAGE_UPLOAD);
+				staged = upload_frame(mpctx, frame);
+			}
+			frame.buffer.reset();
+			if (!staged)
+			{
+				frame = {};
+				has_pending = false;
+				continue;
+			}
+
+			draw_frame(mpctx, staged, overlay);
+			uploaded = true;
+			staged_at = std::chrono::steady_clock::now();
+			continue;
+		}
+
+		int64_t lead_us = mpctx->clock->until_us(pts_us);
+		if (mpctx->vsync) lead_us -= refresh / 2;
+
+		if (lead_us > player_t::spin_us)
+		{
+			auto deadline = std::chrono::steady_clock::now() + std::chrono::microseconds(lead_us - player_t::spin_us);
+			mpctx->wait_state_until(deadline, [&]()
+				{
+					return mpctx->state.load() != player_t::PLAYING || frame.serial != mpctx->serial.load() || has_commands();
+				});
+			continue;
+		}
+
+		if (lead_us > 0)
+			spin_until(std::chrono::steady_clock::now() + std::chrono::microseconds(lead_us));
+
+		telemetry.record_since(telemetry_t::STAGE_PRESENT_WAIT, staged_at);
+
+		{
+			stage_timer_t timer(telemetry, telemetry_t::STAGE_PRESENT);
+			SDL_RenderPresent(mpctx->renderer);
+		}
+		shown = staged;
+
+		last_present_us = get_playback_us(mpctx);
+		int64_t error_us = last_present_us - pts_us;
+		overlay.drift_us = error_us;
+		mpctx->present_stats.add(error_us, refresh);
+		telemetry.av_offset.record(static_cast<uint64_t>(std::abs(error_us)));
+		if (refresh > 0 && error_us > refresh)
+			telemetry.late.fetch_add(1);
+
+		frame = {};
+		has_pending = false;
+	}
+
+	close_renderer(mpctx);
+}
+
+void print_telemetry(player_t* mpctx)
+{
+	mpctx->telemetry.print();
+	printf("  frames: decoded %llu, dropped %llu, skipped %llu, late %llu, decoder ratio %d%%\n",
+		static_cast<unsigned long long>(mpctx->decoded_vframes.load()),
+		static_cast<unsigned long long>(mpctx->overload.dropped.load()),
+		static_cast<unsigned long long>(mpctx->overload.skipped.load()),
+		static_cast<unsigned long long>(mpctx->telemetry.late.load()),
+		mpctx->overload.ratio.load());
+}
+
+void SDLCALL audio_callback(void* userdata, SDL_AudioStream* stream, int additional_amount, int)
+{
+	auto* mpctx = static_cast<player_t*>(userdata);
+	if (mpctx->state.load() != player_t::PLAYING) return;
+
+	g_trace()->name_thread("audio callback");
+	trace_scope_t trace("audio submit");
+
+	uint32_t serial = mpctx->serial.load();
+	float volume = mpctx->volume.load();
+
+	auto& chunk = mpctx->pcm_current;
+	size_t wanted = static_cast<size_t>(std::max(additional_amount, 0)) / sizeof(float);
+	float block[1024];
+
+	while (wanted > 0)
+	{
+		if (mpctx->pcm_consumed >= chunk.samples)
+		{
+			if (!mpctx->pcm_chunks.try_pop(chunk)) break;
+			mpctx->pcm_consumed = 0;
+		}
+
+		size_t left = chunk.samples - mpctx->pcm_consumed;
+		if (chunk.serial != serial)
+		{
+			mpctx->pcm.skip(left);
+			mpctx->pcm_consumed = chunk.samples;
+			continue;
+		}
+
+		size_t limit = std::size(block) / chunk.channels * chunk.channels;
+		size_t n = mpctx->pcm.read(block, std::min({ wanted, left, limit }));
+		if (!n) break;
+
+		dsp().gain_f32(block, n, volume);
+		SDL_PutAudioStreamData(stream, block, static_cast<int>(n * sizeof(float)));
+
+		mpctx->pcm_consumed += n;
+		wanted -= n;
+
+		int64_t frames = static_cast<int64_t>(mpctx->pcm_consumed / chunk.channels);
+		mpctx->audio_end_us.store(chunk.pts * 1000 + frames * 1000000ll / chunk.sample_rate);
+	}
+}
+
+// Maps key presses to player commands. Volume and seek follow key repeat; repeated seeks are
+// spaced out so each restarted decode gets to show a frame.
+struct input_t
+{
+	static constexpr auto seek_repeat = std::chrono::milliseconds(300);
+
+	std::chrono::steady_clock::time_point last_seek{};
+
+	player_t::player_cmd_t translate(const SDL_KeyboardEvent& key)
+	{
+		switch (key.key)
+		{
+		case SDLK_Q:
+			return key.repeat ? player_t::CMD_NONE : player_t::CMD_QUIT;
+		case SDLK_SPACE:
+			return key.repeat ? player_t::CMD_NONE : player_t::CMD_PAUSE;
+		case SDLK_T:
+			return key.repeat ? player_t::CMD_NONE : player_t::CMD_STATS;
+		case SDLK_O:
+			return key.repeat ? player_t::CMD_NONE : player_t::CMD_OVERLAY;
+		case SDLK_UP:
+			return player_t::CMD_VOLUME_UP;
+		case SDLK_DOWN:
+			return player_t::CMD_VOLUME_DOWN;
+		case SDLK_LEFT:
+		case SDLK_RIGHT:
+		{
+			auto now = std::chrono::steady_clock::now();
+			if (key.repeat && now - last_seek < seek_repeat)
+				return player_t::CMD_NONE;
+
+			last_seek = now;
+			return key.key == SDLK_LEFT ? player_t::CMD_SEEK_BACK : player_t::CMD_SEEK_FORWARD;
+		}
+		}
+		return player_t::CMD_NONE;
+	}
+};
+
+void run_player_commands(player_t* mpctx)
+{
+	int64_t seek_ms = 0;
+
+	player_t::player_cmd_t cmd;
+	while (mpctx->commands.try_pop(cmd))
+	{
+		switch (cmd)
+		{
+		case player_t::CMD_QUIT:
+			mpctx->set_state(player_t::STOPPED);
+			return;
+		case player_t::CMD_PAUSE:
+		{
+			auto state = mpctx->state.load();
+
+			if (state == player_t::PLAYING)
+			{
+				SDL_PauseAudioStreamDevice(mpctx->audio_stream);
+				mpctx->set_state(player_t::PAUSED);
+			}
+			else if (state == player_t::PAUSED)
+			{
+				SDL_ResumeAudioStreamDevice(mpctx->audio_stream);
+				mpctx->set_state(player_t::PLAYING);
+			}
+			break;
+		}
+		case player_t::CMD_VOLUME_UP:
+		{
+			float v = mpctx->volume.load();
+			if (v < 3.0f) mpctx->volume.store(v + 0.1f);
+			break;
+		}
+		case player_t::CMD_VOLUME_DOWN:
+		{
+			float v = mpctx->volume.load();
+			if (v > 0.0f) mpctx->volume.store(v - 0.1f);
+			break;
+		}
+		case player_t::CMD_SEEK_BACK:
+			seek_ms -= 1000;
+			break;
+		case player_t::CMD_SEEK_FORWARD:
+			seek_ms += 1000;
+			break;
+		case player_t::CMD_STATS:
+			print_telemetry(mpctx);
+			break;
+		case player_t::CMD_OVERLAY:
+			mpctx->post_render(player_t::RENDER_OVERLAY);
+			break;
+		default:
+			break;
+		}
+	}
+
+	if (seek_ms)
+		handle_seek(mpctx, seek_ms);
+}
+
+// Stands in for the audio device under the virtual clock: consumes PCM as soon as it is queued.
+void drain_audio(player_t* mpctx)
+{
+	g_trace()->name_thread("audio drain");
+
+	player_t::pcm_chunk_t chunk;
+	float block[1024];
+
+	while (mpctx->pcm_chunks.pop(chunk))
+	{
+		float volume = mpctx->volume.load();
+		for (size_t left = chunk.samples; left > 0;)
+		{
+			size_t n = mpctx->pcm.read(block, std::min(left, std::size(block)));
+			if (!n) break;
+
+			dsp().gain_f32(block, n, volume);
+			left -= n;
+		}
+	}
+}
+
+#ifdef _WIN32
+int wmain(int argc, wchar_t** argv)
+#else
+int main(int argc, char** argv)
+#endif
+{
+	std::unique_ptr<player_t> mpctx = std::make_unique<player_t>();
+	player_t* ptrmpctx = mpctx.get();
+
+	mpctx->password = { 'z', '1', 'x', '2', 'c', '3', 'v', '4', 'b', '5', 'n', '6' };
+
+	mpctx->decoder_threads = default_decoder_threads();
+	printf("dsp: %s\n", dsp().name);
+	bool force_iyuv = false;
+	bool virtual_clock = false;
+	std::vector<std::filesystem::path> args(argv + 1, argv + argc);
+	for (size_t i = 0; i < args.size(); ++i)
+	{
+		if (args[i] == "--threads" && i + 1 < args.size())
+			mpctx->decoder_threads = std::max(0, static_cast<int>(strtol(args[++i].string().c_str(), 0, 10)));
+		else if (args[i] == "--iyuv")
+			force_iyuv = true;
+		else if (args[i] == "--virtual-clock")
+			virtual_clock = true;
+		else if (args[i] == "--trace" && i + 1 < args.size())
+			g_trace()->start(args[++i]);
+		else
+			mpctx->playlist.push_back(args[i]);
+	}
+
+	if (mpctx->playlist.empty())
+		mpctx->playlist.push_back(L"C:\\C\\1_x265_enc.mp4");
+
+	g_trace()->name_thread("main");
+
+	if (virtual_clock)
+		mpctx->clock = std::make_unique<virtual_clock_t>();
+	else
+		mpctx->clock = std::make_unique<realtime_clock_t>(ptrmpctx);
+
+	mpctx->media.resize(mpctx->playlist.size());
+	mpctx->media[0] = std::make_unique<player_t::media_t>();
+	if (int err = load_media(ptrmpctx, mpctx->playlist[0], *mpctx->media[0]))
+		return err;
+
+	const track_t* video_track = mpctx->media[0]->video_track;
+	const track_t* audio_track = mpctx->media[0]->audio_track;
+
+	{
+		if (!SDL_Init(SDL_INIT_VIDEO | (virtual_clock ? 0 : SDL_INIT_AUDIO))) return 6;
+
+		mpctx->window = SDL_CreateWindow("playa", video_track->width / 1.5, video_track->height / 1.5, SDL_WINDOW_RESIZABLE);
+		if (!mpctx->window) return 8;
+
+		update_refresh_rate(ptrmpctx);
+	}
+
+	// The device opens even when the first item has no audio, so later items' audio has somewhere to go.
+	int track_rate = audio_track ? static_cast<int>(audio_track->sample_rate) : 48000;
+	int track_channels = audio_track ? std::min<int>(audio_track->channel_count, player_t::pcm_chunk_t::max_channels) : 2;
+
+	if (virtual_clock)
+	{
+		mpctx->output_rate = track_rate;
+		mpctx->output_channels = track_channels;
+	}
+	else
+	{
+		SDL_AudioSpec device_spec{};
+		int device_frames = 0;
+		SDL_GetAudioDeviceFormat(SDL_AUDIO_DEVICE_DEFAULT_PLAYBACK, &device_spec, &device_frames);
+
+		SDL_AudioSpec audio_spec{};
+		audio_spec.freq = device_spec.freq > 0 ? device_spec.freq : track_rate;
+		audio_spec.channels = track_channels;
+		audio_spec.format = SDL_AUDIO_F32;
+
+		mpctx->audio_stream = SDL_OpenAudioDeviceStream(SDL_AUDIO_DEVICE_DEFAULT_PLAYBACK, &audio_spec, audio_callback, ptrmpctx);
+		if (!mpctx->audio_stream)
+			return 11;
+
+		mpctx->output_rate = audio_spec.freq;
+		mpctx->output_channels = audio_spec.channels;
+		mpctx->audio_bytes_per_sec = static_cast<int64_t>(audio_spec.freq) * audio_spec.channels * sizeof(float);
+		mpctx->audio_latency_us = device_frames * 1000000ll / audio_spec.freq;
+
+		SDL_ResumeAudioStreamDevice(mpctx->audio_stream);
+	}
+
+	mpctx->set_state(player_t::PLAYING);
+	auto run_start = std::chrono::steady_clock::now();
+
+	std::vector<std::jthread> threads;
+	threads.emplace_back(play_vframe, ptrmpctx, static_cast<int>(video_track->width), static_cast<int>(video_track->height), force_iyuv);
+
+	mpctx->wait_state([&]() { return mpctx->render_status.load() != 0; });
+	if (int status = mpctx->render_status.load(); status < 0)
+	{
+		mpctx->set_state(player_t::STOPPED);
+		return -status;
+	}
+
+	threads.emplace_back(decode_video, ptrmpctx);
+	threads.emplace_back(decode_audio, ptrmpctx);
+	threads.emplace_back(preload_media, ptrmpctx);
+	if (virtual_clock)
+		threads.emplace_back(drain_audio, ptrmpctx);
+
+	input_t input;
+
+	while (mpctx->state.load() != player_t::STOPPED)
+	{
+		SDL_Event e;
+		if (!SDL_WaitEventTimeout(&e, 250))
+			continue;
+
+		do
+		{
+			switch (e.type)
+			{
+			case SDL_EVENT_QUIT:
+				mpctx->set_state(player_t::STOPPED);
+				break;
+			case SDL_EVENT_WINDOW_DISPLAY_CHANGED:
+				update_refresh_rate(ptrmpctx);
+				break;
+			case SDL_EVENT_WINDOW_RESIZED:
+			case SDL_EVENT_WINDOW_PIXEL_SIZE_CHANGED:
+			case SDL_EVENT_WINDOW_RESTORED:
+			case SDL_EVENT_WINDOW_EXPOSED:
+				mpctx->post_render(player_t::RENDER_REDRAW);
+				break;
+			case SDL_EVENT_WINDOW_MOVED:
+				break;
+			case SDL_EVENT_KEY_DOWN:
+				if (auto cmd = input.translate(e.key); cmd != player_t::CMD_NONE)
+					mpctx->commands.try_push(std::move(cmd));
+				break;
+			}
+		} while (SDL_PollEvent(&e));
+
+		run_player_commands(ptrmpctx);
+	}
+
+	threads.clear();
+
+	print_telemetry(ptrmpctx);
+	g_trace()->write();
+
+	if (virtual_clock)
+	{
+		double elapsed_ms = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - run_start).count();
+		printf("virtual clock: %llu frames, %llu dropped, %llu skipped, %lld ms of media in %.0f ms (%.1f fps)\n",
+			static_cast<unsigned long long>(mpctx->present_stats.count),
+			static_cast<unsigned long long>(mpctx->overload.dropped.load()),
+			static_cast<unsigned long long>(mpctx->overload.skipped.load()),
+			static_cast<long long>(mpctx->clock->now_us() / 1000), elapsed_ms,
+			elapsed_ms > 0.0 ? mpctx->present_stats.count * 1000.0 / elapsed_ms : 0.0);
+	}
+
+	const auto& ps = mpctx->present_stats;
+	printf("present: %llu frames, error mean %.0f us, stddev %.0f us, max %lld us, missed %llu, refresh %lld us, vsync %d\n",
+		static_cast<unsigned long long>(ps.count), ps.mean_us(), ps.stddev_us(),
+		static_cast<long long>(ps.max_us), static_cast<unsigned long long>(ps.missed),
+		static_cast<long long>(mpctx->refresh_us.load()), mpctx->vsync ? 1 : 0);
+
+	SDL_Quit();
+
+	return 0;
 }
\ No newline at end of file
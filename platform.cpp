@@ -0,0 +1,130 @@
+#define __STDC_WANT_LIB_EXT1__ 1
+#include "include.h"
+
+#ifndef _WIN32
+#include <string.h>
+#include <termios.h>
+#include <unistd.h>
+#include <sys/resource.h>
+#endif
+
+void secure_zero(void* data, size_t size)
+{
+#if defined(_WIN32)
+	SecureZeroMemory(data, size);
+#elif defined(__APPLE__)
+	memset_s(data, size, 0, size);
+#else
+	explicit_bzero(data, size);
+#endif
+}
+
+void zclear_console()
+{
+#ifdef _WIN32
+	HANDLE h = GetStdHandle(STD_OUTPUT_HANDLE);
+	CONSOLE_SCREEN_BUFFER_INFO csbi;
+	DWORD written;
+	GetConsoleScreenBufferInfo(h, &csbi);
+	DWORD size = csbi.dwSize.X * csbi.dwSize.Y;
+	FillConsoleOutputCharacter(h, ' ', size, { 0, 0 }, &written);
+	FillConsoleOutputAttribute(h, csbi.wAttributes, size, { 0, 0 }, &written);
+	SetConsoleCursorPosition(h, { 0, 0 });
+#else
+	fputs("\033[2J\033[H", stdout);
+	fflush(stdout);
+#endif
+}
+
+bool read_password(std::vector<char>& password)
+{
+	char data[256] = { 0 };
+	size_t br = 0;
+
+#ifdef _WIN32
+	HANDLE hi = GetStdHandle(STD_INPUT_HANDLE);
+	if (hi == INVALID_HANDLE_VALUE) return false;
+
+	DWORD mode = 0;
+	bool console = GetConsoleMode(hi, &mode) != 0;
+	if (console) SetConsoleMode(hi, mode & ~ENABLE_ECHO_INPUT);
+
+	DWORD read = 0;
+	bool ok = ReadFile(hi, data, 255, &read, NULL) != 0;
+	br = read;
+
+	if (console)
+	{
+		SetConsoleMode(hi, mode);
+		fputs("\n", stdout);
+	}
+#else
+	termios saved{};
+	bool tty = tcgetattr(STDIN_FILENO, &saved) == 0;
+	if (tty)
+	{
+		termios silent = saved;
+		silent.c_lflag &= ~ECHO;
+		tcsetattr(STDIN_FILENO, TCSAFLUSH, &silent);
+	}
+
+	ssize_t n = read(STDIN_FILENO, data, 255);
+	bool ok = n >= 0;
+	br = ok ? static_cast<size_t>(n) : 0;
+
+	if (tty)
+	{
+		tcsetattr(STDIN_FILENO, TCSAFLUSH, &saved);
+		fputs("\n", stdout);
+	}
+#endif
+
+	if (!ok)
+	{
+		secure_zero(data, sizeof(data));
+		return false;
+	}
+
+	while (br && (data[br - 1] == '\n' || data[br - 1] == '\r'))
+		data[--br] = '\0';
+
+	password.assign(data, data + br);
+	secure_zero(data, sizeof(data));
+	return true;
+}
+
+double working_set_mb()
+{
+#if defined(_WIN32)
+	PROCESS_MEMORY_COUNTERS pmc{};
+	if (!GetProcessMemoryInfo(GetCurrentProcess(), &pmc, sizeof(pmc))) return 0.0;
+	return pmc.WorkingSetSize / (1024.0 * 1024.0);
+#elif defined(__linux__)
+	long pages = 0, resident = 0;
+	FILE* f = fopen("/proc/self/statm", "r");
+	if (!f) return 0.0;
+	int fields = fscanf(f, "%ld %ld", &pages, &resident);
+	fclose(f);
+	if (fields != 2) return 0.0;
+	return static_cast<double>(resident) * sysconf(_SC_PAGESIZE) / (1024.0 * 1024.0);
+#else
+	return peak_working_set_mb();
+#endif
+}
+
+double peak_working_set_mb()
+{
+#ifdef _WIN32
+	PROCESS_MEMORY_COUNTERS pmc{};
+	if (!GetProcessMemoryInfo(GetCurrentProcess(), &pmc, sizeof(pmc))) return 0.0;
+	return pmc.PeakWorkingSetSize / (1024.0 * 1024.0);
+#else
+	rusage usage{};
+	if (getrusage(RUSAGE_SELF, &usage)) return 0.0;
+#ifdef __APPLE__
+	return usage.ru_maxrss / (1024.0 * 1024.0);
+#else
+	return usage.ru_maxrss / 1024.0;
+#endif
+#endif
+}
\ No newline at end of file
@@ -0,0 +1,20 @@
+#pragma once
+#ifndef _PLATFORM_H_
+#define _PLATFORM_H_
+
+#include "include.h"
+
+// Win32 and POSIX implementations live in platform.cpp.
+
+// Zeroes memory in a way the compiler may not optimize away.
+void secure_zero(void* data, size_t size);
+
+void zclear_console();
+
+// Reads one line from stdin with echo off.
+bool read_password(std::vector<char>& password);
+
+double working_set_mb();
+double peak_working_set_mb();
+
+#endif
\ No newline at end of file
@@ -1,228 +1,468 @@
-#pragma once
-#ifndef _MP4_H_
-#define _MP4_H_
-
-#include "include.h"
-
-struct atom_t
-{
-	atom_t(uint64_t offset, uint64_t size, const std::string& type) : _offset(offset), _size(size), _type(type) {}
-
-	uint64_t _offset = 0;
-	uint64_t _size = 0;
-	std::string _type;
-	std::vector<std::unique_ptr<atom_t>> _children;
-
-	virtual void parse(memstream_t* stream);
-	static std::unique_ptr<atom_t> create_atom(uint64_t offset, uint64_t size, const std::string& type);
-};
-
-struct mdhd_atom_t : public atom_t
-{
-	mdhd_atom_t(uint64_t offset, uint64_t size, const std::string& type) : atom_t(offset, size, type) {}
-
-	uint32_t timescale = 0;
-	uint32_t duration = 0;
-
-	void parse(memstream_t* stream) override;
-};
-
-struct hdlr_atom_t : public atom_t
-{
-	hdlr_atom_t(uint64_t offset, uint64_t size, const std::string& type) : atom_t(offset, size, type) {}
-
-	uint32_t type = 0;
-
-	void parse(memstream_t* stream) override;
-};
-
-struct stsz_atom_t : public atom_t
-{
-	stsz_atom_t(uint64_t offset, uint64_t size, const std::string& type) : atom_t(offset, size, type) {}
-
-	std::vector<uint32_t> entries;
-
-	void parse(memstream_t* stream) override;
-};
-
-struct stsc_atom_t : public atom_t
-{
-	stsc_atom_t(uint64_t offset, uint64_t size, const std::string& type) : atom_t(offset, size, type) {}
-
-	struct entry_t
-	{
-		uint32_t first_chunk;
-		uint32_t samples_per_chunk;
-		uint32_t sample_description_index;
-	};
-
-	std::vector<entry_t> entries;
-
-	void parse(memstream_t* stream) override;
-};
-
-struct stco_atom_t : public atom_t
-{
-	stco_atom_t(uint64_t offset, uint64_t size, const std::string& type) : atom_t(offset, size, type) {}
-
-	std::vector<uint32_t> entries;
-
-	void parse(memstream_t* stream) override;
-};
-
-struct stts_atom_t : public atom_t
-{
-	stts_atom_t(uint64_t offset, uint64_t size, const std::string& type) : atom_t(offset, size, type) {}
-
-	struct entry_t
-	{
-		uint32_t sample_count;
-		uint32_t sample_delta;
-	};
-
-	std::vector<entry_t> entries;
-
-	void parse(memstream_t* stream) override;
-};
-
-struct ctts_atom_t : public atom_t
-{
-	ctts_atom_t(uint64_t offset, uint64_t size, const std::string& type) : atom_t(offset, size, type) {}
-
-	struct entry_t
-	{
-		uint32_t sample_count;
-		uint32_t sample_offset;
-	};
-
-	std::vector<entry_t> entries;
-
-	void parse(memstream_t* stream) override;
-};
-
-struct stss_atom_t : public atom_t
-{
-	stss_atom_t(uint64_t offset, uint64_t size, const std::string& type) : atom_t(offset, size, type) {}
-
-	std::vector<uint32_t> entries;
-
-	void parse(memstream_t* stream) override;
-};
-
-struct stsd_atom_t : public atom_t
-{
-	stsd_atom_t(uint64_t offset, uint64_t size, const std::string& type) : atom_t(offset, size, type) {}
-
-	std::vector<std::vector<std::vector<uint8_t>>> nal_units;
-	std::vector<uint8_t> asc_bytes;
-
-	uint32_t width = 0;
-	uint32_t height = 0;
-	uint16_t channel_count = 0;
-	uint16_t sample_size = 0;
-	float sample_rate = 0;
-
-	uint32_t type = 0;
-
-	void parse(memstream_t* stream, uint32_t htype);
-};
-
-struct sample_t
-{
-	uint32_t duration = 0;
-	uint64_t file_offset = 0;
-	uint32_t size = 0;
-	uint32_t decode_time = 0;
-	uint32_t composition_offset = 0;
-	uint64_t presentation_time = 0;
-	bool is_keyframe = true;
-};
-
-struct track_t
-{
-	uint32_t type = 0;
-	uint32_t timescale = 0;
-	uint64_t duration = 0;
-
-	uint32_t width = 0;
-	uint32_t height = 0;
-
-	uint32_t channel_count = 0;
-	uint32_t sample_rate = 0;
-	uint32_t sample_size = 0;
-
-	stsd_atom_t* stsd = 0;
-	stts_atom_t* stts = 0;
-	stss_atom_t* stss = 0;
-	ctts_atom_t* ctts = 0;
-	stsc_atom_t* stsc = 0;
-	stsz_atom_t* stsz = 0;
-	stco_atom_t* stco = 0;
-
-	std::vector<sample_t> samples;
-};
-
-struct mp4_t
-{
-	bool parse(memstream_t* stream);
-	void build_samples(track_t& track);
-
-	std::vector<track_t> _tracks;
-	std::vector<std::unique_ptr<atom_t>> _atoms;
-};
-
-struct player_t
-{
-	struct video_frame_t
-	{
-		uint64_t pts = 0;
-		int width = 0;
-		int height = 0;
-		std::array<std::vector<uint8_t>, 3> planes{};
-		std::array<int, 3> strides{};
-	};
-
-	struct audio_frame_t
-	{
-		uint64_t pts = 0;
-		int sample_rate = 0;
-		int channels = 0;
-		int frame_size = 0;
-		std::vector<int16_t> pcm;
-	};
-
-	SDL_Window* window = 0;
-	SDL_Renderer* renderer = 0;
-	SDL_Texture* texture = 0;
-	SDL_AudioStream* audio_stream = 0;
-
-	enum state_t { PLAYING, PAUSED, STOPPED, SEEKING };
-	std::atomic<state_t> state = STOPPED;
-
-	std::unique_ptr<mp4_t> mp4;
-
-	std::mutex stream_mutex;
-	std::unique_ptr<memstream_t> stream;
-
-	const track_t* video_track = 0;
-	const track_t* audio_track = 0;
-
-	safe_queue<video_frame_t, 20> video_frames;
-	safe_queue<audio_frame_t, 20> audio_frames;
-
-	safe_queue<player_t::video_frame_t> play_vframes;
-	safe_queue<player_t::audio_frame_t> play_aframes;
-
-	std::chrono::steady_clock::time_point pause_time;
-	std::chrono::steady_clock::time_point base_clock;
-
-	std::atomic<size_t> v_idx{ 0 };
-	std::atomic<size_t> a_idx{ 0 };
-
-	std::atomic<bool> dec_audiof{ false };
-	std::atomic<bool> dec_videof{ false };
-
-	std::atomic<float> volume{ 1.0f };
-};
-
+#pragma once
+#ifndef _MP4_H_
+#define _MP4_H_
+
+#include "include.h"
+
+struct atom_t
+{
+	atom_t(uint64_t offset, uint64_t size, const std::string& type) : _offset(offset), _size(size), _type(type) {}
+
+	uint64_t _offset = 0;
+	uint64_t _size = 0;
+	std::string _type;
+	std::vector<std::unique_ptr<atom_t>> _children;
+
+	virtual void parse(memstream_t* stream);
+	static std::unique_ptr<atom_t> create_atom(uint64_t offset, uint64_t size, const std::string& type);
+};
+
+struct mdhd_atom_t : public atom_t
+{
+	mdhd_atom_t(uint64_t offset, uint64_t size, const std::string& type) : atom_t(offset, size, type) {}
+
+	uint32_t timescale = 0;
+	uint32_t duration = 0;
+
+	void parse(memstream_t* stream) override;
+};
+
+struct hdlr_atom_t : public atom_t
+{
+	hdlr_atom_t(uint64_t offset, uint64_t size, const std::string& type) : atom_t(offset, size, type) {}
+
+	uint32_t type = 0;
+
+	void parse(memstream_t* stream) override;
+};
+
+struct stsz_atom_t : public atom_t
+{
+	stsz_atom_t(uint64_t offset, uint64_t size, const std::string& type) : atom_t(offset, size, type) {}
+
+	std::vector<uint32_t> entries;
+
+	void parse(memstream_t* stream) override;
+};
+
+struct stsc_atom_t : public atom_t
+{
+	stsc_atom_t(uint64_t offset, uint64_t size, const std::string& type) : atom_t(offset, size, type) {}
+
+	struct entry_t
+	{
+		uint32_t first_chunk;
+		uint32_t samples_per_chunk;
+		uint32_t sample_description_index;
+	};
+
+	std::vector<entry_t> entries;
+
+	void parse(memstream_t* stream) override;
+};
+
+struct stco_atom_t : public atom_t
+{
+	stco_atom_t(uint64_t offset, uint64_t size, const std::string& type) : atom_t(offset, size, type) {}
+
+	std::vector<uint32_t> entries;
+
+	void parse(memstream_t* stream) override;
+};
+
+struct stts_atom_t : public atom_t
+{
+	stts_atom_t(uint64_t offset, uint64_t size, const std::string& type) : atom_t(offset, size, type) {}
+
+	struct entry_t
+	{
+		uint32_t sample_count;
+		uint32_t sample_delta;
+	};
+
+	std::vector<entry_t> entries;
+
+	void parse(memstream_t* stream) override;
+};
+
+struct ctts_atom_t : public atom_t
+{
+	ctts_atom_t(uint64_t offset, uint64_t size, const std::string& type) : atom_t(offset, size, type) {}
+
+	struct entry_t
+	{
+		uint32_t sample_count;
+		uint32_t sample_offset;
+	};
+
+	std::vector<entry_t> entries;
+
+	void parse(memstream_t* stream) override;
+};
+
+struct stss_atom_t : public atom_t
+{
+	stss_atom_t(uint64_t offset, uint64_t size, const std::string& type) : atom_t(offset, size, type) {}
+
+	std::vector<uint32_t> entries;
+
+	void parse(memstream_t* stream) override;
+};
+
+struct stsd_atom_t : public atom_t
+{
+	stsd_atom_t(uint64_t offset, uint64_t size, const std::string& type) : atom_t(offset, size, type) {}
+
+	std::vector<std::vector<std::vector<uint8_t>>> nal_units;
+	std::vector<uint8_t> asc_bytes;
+
+	uint32_t width = 0;
+	uint32_t height = 0;
+	uint16_t channel_count = 0;
+	uint16_t sample_size = 0;
+	float sample_rate = 0;
+
+	uint32_t type = 0;
+
+	void parse(memstream_t* stream, uint32_t htype);
+};
+
+struct sample_t
+{
+	uint32_t duration = 0;
+	uint64_t file_offset = 0;
+	uint32_t size = 0;
+	uint32_t decode_time = 0;
+	uint32_t composition_offset = 0;
+	uint64_t presentation_time = 0;
+	bool is_keyframe = true;
+};
+
+struct track_t
+{
+	uint32_t type = 0;
+	uint32_t timescale = 0;
+	uint64_t duration = 0;
+
+	uint32_t width = 0;
+	uint32_t height = 0;
+
+	uint32_t channel_count = 0;
+	uint32_t sample_rate = 0;
+	uint32_t sample_size = 0;
+
+	stsd_atom_t* stsd = 0;
+	stts_atom_t* stts = 0;
+	stss_atom_t* stss = 0;
+	ctts_atom_t* ctts = 0;
+	stsc_atom_t* stsc = 0;
+	stsz_atom_t* stsz = 0;
+	stco_atom_t* stco = 0;
+
+	std::vector<sample_t> samples;
+};
+
+struct mp4_t
+{
+	bool parse(memstream_t* stream);
+	void build_samples(track_t& track);
+
+	std::vector<track_t> _tracks;
+	std::vector<std::unique_ptr<atom_t>> _atoms;
+};
+
+struct player_t
+{
+	struct video_frame_t
+	{
+		uint64_t pts = 0;
+		uint32_t serial = 0;
+		int width = 0;
+		int height = 0;
+		int bit_depth = 8;
+		de265_chroma chroma = de265_chroma_420;
+		frame_ref_t buffer;
+		std::array<const uint8_t*, 3> planes{};
+		std::array<int, 3> strides{};
+	};
+
+	struct pcm_chunk_t
+	{
+		static constexpr size_t max_frames = 2048;
+		static constexpr size_t max_samples = max_frames * 2 * 2;
+		static constexpr int max_channels = 8;
+
+		uint64_t pts = 0;
+		uint32_t serial = 0;
+		int sample_rate = 0;
+		int channels = 0;
+		size_t samples = 0;
+	};
+
+	struct media_t
+	{
+		std::filesystem::path path;
+		std::unique_ptr<memstream_t> stream;
+		std::unique_ptr<mp4_t> mp4;
+
+		const track_t* video_track = 0;
+		const track_t* audio_track = 0;
+
+		uint64_t offset_ms = 0;
+		uint64_t duration_ms = 0;
+
+		de265_decoder_context* primed_decoder = 0;
+		size_t primed_next = 0;
+		std::vector<video_frame_t> primed_frames;
+
+		media_t() = default;
+		media_t(const media_t&) = delete;
+		media_t& operator=(const media_t&) = delete;
+
+		~media_t()
+		{
+			primed_frames.clear();
+			if (primed_decoder) de265_free_decoder(primed_decoder);
+		}
+	};
+
+	struct overload_t
+	{
+		static constexpr int64_t behind_ms = 0;
+		static constexpr int64_t headroom_ms = 250;
+		static constexpr int64_t late_drop_ms = 50;
+		static constexpr int64_t min_present_ms = 250;
+		static constexpr int hold_frames = 30;
+
+		std::atomic<int> ratio{ 100 };
+		std::atomic<uint64_t> dropped{ 0 };
+		std::atomic<uint64_t> skipped{ 0 };
+
+		int behind = 0;
+		int ahead = 0;
+		int hold = 0;
+
+		void attach(de265_decoder_context* decoder)
+		{
+			behind = ahead = hold = 0;
+			de265_set_framerate_ratio(decoder, ratio.load());
+		}
+
+		void update(de265_decoder_context* decoder, int64_t lead_ms)
+		{
+			if (hold > 0)
+			{
+				--hold;
+				return;
+			}
+
+			if (lead_ms < behind_ms)
+			{
+				ahead = 0;
+				if (++behind >= 3 && ratio.load() > 0)
+				{
+					ratio.store(de265_change_framerate(decoder, -1));
+					behind = 0;
+					hold = hold_frames;
+				}
+			}
+			else if (lead_ms > headroom_ms && ratio.load() < 100)
+			{
+				behind = 0;
+				if (++ahead >= hold_frames)
+				{
+					ratio.store(de265_change_framerate(decoder, +1));
+					ahead = 0;
+					hold = hold_frames;
+				}
+			}
+			else
+			{
+				behind = ahead = 0;
+			}
+		}
+	};
+
+	struct present_stats_t
+	{
+		uint64_t count = 0;
+		uint64_t missed = 0;
+		double sum_us = 0.0;
+		double sum_sq_us = 0.0;
+		int64_t max_us = 0;
+
+		void add(int64_t error_us, int64_t refresh_us)
+		{
+			++count;
+			sum_us += static_cast<double>(error_us);
+			sum_sq_us += static_cast<double>(error_us) * error_us;
+			max_us = std::max(max_us, std::abs(error_us));
+			if (refresh_us > 0 && error_us > refresh_us) ++missed;
+		}
+
+		double mean_us() const { return count ? sum_us / count : 0.0; }
+		double stddev_us() const
+		{
+			if (!count) return 0.0;
+			double mean = mean_us();
+			return std::sqrt(std::max(0.0, sum_sq_us / count - mean * mean));
+		}
+	};
+
+	SDL_Window* window = 0;
+	SDL_Renderer* renderer = 0;
+	enum texture_kind_t { TEXTURE_IYUV, TEXTURE_NV12, TEXTURE_P010 };
+	static constexpr size_t texture_count = 2;
+	std::array<SDL_Texture*, texture_count> textures{};
+	size_t texture_idx = 0;
+	int texture_w = 0;
+	int texture_h = 0;
+	texture_kind_t texture_kind = TEXTURE_IYUV;
+	bool nv12_supported = false;
+	bool p010_supported = false;
+	std::vector<uint8_t> upload_scratch;
+	SDL_AudioStream* audio_stream = 0;
+
+	enum render_cmd_t { RENDER_NONE, RENDER_REDRAW, RENDER_OVERLAY };
+	spsc_ring<render_cmd_t, 16> render_cmds;
+	std::atomic<int> render_status{ 0 };
+
+	// Posted by the main thread's input handling, run on the main thread between event waits.
+	enum player_cmd_t { CMD_NONE, CMD_QUIT, CMD_PAUSE, CMD_VOLUME_UP, CMD_VOLUME_DOWN, CMD_SEEK_BACK, CMD_SEEK_FORWARD, CMD_STATS, CMD_OVERLAY };
+	spsc_ring<player_cmd_t, 64> commands;
+
+	enum state_t { PLAYING, PAUSED, STOPPED, SEEKING };
+	std::atomic<state_t> state = STOPPED;
+	std::atomic<uint32_t> serial{ 0 };
+
+	std::mutex state_mtx;
+	std::condition_variable state_cv;
+
+	static constexpr size_t prime_frames = 8;
+
+	frame_pool_t vframe_pool;
+
+	std::vector<char> password;
+	std::vector<std::filesystem::path> playlist;
+	std::vector<std::unique_ptr<media_t>> media;
+
+	std::atomic<size_t> start_item{ 0 };
+	std::atomic<size_t> v_item{ 0 };
+	std::atomic<size_t> a_item{ 0 };
+
+	spsc_ring<video_frame_t, 20> video_frames;
+
+	pcm_ring<float, 32768> pcm;
+	spsc_ring<pcm_chunk_t, 64> pcm_chunks;
+	pcm_chunk_t pcm_current{};
+	size_t pcm_consumed = 0;
+
+	std::atomic<int64_t> audio_end_us{ -1 };
+	std::atomic<int64_t> clock_base_us{ 0 };
+	std::unique_ptr<playback_clock_t> clock;
+	int output_rate = 0;
+	int output_channels = 0;
+	int64_t audio_bytes_per_sec = 0;
+	int64_t audio_latency_us = 0;
+
+	static constexpr int64_t spin_us = 2000;
+
+	std::atomic<int64_t> refresh_us{ 0 };
+	bool vsync = false;
+	present_stats_t present_stats;
+
+	std::atomic<size_t> v_idx{ 0 };
+	std::atomic<size_t> a_idx{ 0 };
+
+	std::atomic<bool> dec_audiof{ false };
+	std::atomic<bool> dec_videof{ false };
+
+	std::atomic<float> volume{ 1.0f };
+
+	static constexpr int pipeline_threads = 3;
+	int decoder_threads = 0;
+
+	std::atomic<uint64_t> decoded_vframes{ 0 };
+	std::atomic<uint32_t> eof_serial{ UINT32_MAX };
+
+	overload_t overload;
+	telemetry_t telemetry;
+
+	void set_state(state_t s)
+	{
+		static constexpr const char* state_names[] = { "playing", "paused", "stopped", "seeking" };
+		g_trace()->instant(state_names[s]);
+
+		{
+			std::lock_guard<std::mutex> lock(state_mtx);
+			state.store(s);
+		}
+		state_cv.notify_all();
+
+		if (s == STOPPED)
+		{
+			video_frames.shutdown();
+			pcm.shutdown();
+			pcm_chunks.shutdown();
+		}
+	}
+
+	template<typename Pred>
+	void wait_state(Pred pred)
+	{
+		std::unique_lock<std::mutex> lock(state_mtx);
+		state_cv.wait(lock, pred);
+	}
+
+	template<typename Pred>
+	bool wait_state_until(std::chrono::steady_clock::time_point deadline, Pred pred)
+	{
+		std::unique_lock<std::mutex> lock(state_mtx);
+		return state_cv.wait_until(lock, deadline, pred);
+	}
+
+	void wait_serial(uint32_t run_serial)
+	{
+		wait_state([&]() { return state.load() == STOPPED || serial.load() != run_serial; });
+	}
+
+	state_t wait_runnable()
+	{
+		wait_state([&]() { auto s = state.load(); return s == PLAYING || s == STOPPED; });
+		return state.load();
+	}
+
+	media_t* wait_media(size_t item, uint32_t run_serial)
+	{
+		std::unique_lock<std::mutex> lock(state_mtx);
+		state_cv.wait(lock, [&]() { return item >= media.size() || media[item] || interrupted(run_serial); });
+		return item < media.size() && !interrupted(run_serial) ? media[item].get() : 0;
+	}
+
+	void enter_item(std::atomic<size_t>& which, size_t item)
+	{
+		{
+			std::lock_guard<std::mutex> lock(state_mtx);
+			which.store(item);
+		}
+		state_cv.notify_all();
+	}
+
+	void post_render(render_cmd_t cmd)
+	{
+		{
+			std::lock_guard<std::mutex> lock(state_mtx);
+			render_cmds.try_push(std::move(cmd));
+		}
+		state_cv.notify_all();
+		video_frames.wake_consumer();
+	}
+
+	bool interrupted(uint32_t run_serial) const
+	{
+		auto s = state.load();
+		return s == STOPPED || s == SEEKING || run_serial != serial.load();
+	}
+};
+
 #endif
\ No newline at end of file
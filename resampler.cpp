@@ -0,0 +1,110 @@
+#include "include.h"
+#include <numeric>
+
+static double bessel_i0(double x)
+{
+	double sum = 1.0, term = 1.0;
+	for (int k = 1; k < 32; ++k)
+	{
+		term *= (x / (2.0 * k)) * (x / (2.0 * k));
+		sum += term;
+	}
+	return sum;
+}
+
+bool resampler_t::init(int in_rate, int out_rate, int channels)
+{
+	if (in_rate <= 0 || out_rate <= 0 || channels <= 0) return false;
+
+	int g = std::gcd(in_rate, out_rate);
+	if (out_rate / g > max_phases) return false;
+
+	in_rate_ = in_rate;
+	out_rate_ = out_rate;
+	channels_ = channels;
+	up_ = out_rate / g;
+	down_ = in_rate / g;
+
+	coeffs_.clear();
+	if (!passthrough())
+	{
+		const double beta = 8.0;
+		const double half = taps / 2.0;
+		const double center = half - 1.0;
+		const double cutoff = 0.97 * std::min(1.0, static_cast<double>(out_rate) / in_rate);
+		const double pi = 3.14159265358979323846;
+
+		coeffs_.resize(static_cast<size_t>(up_) * taps);
+		for (int p = 0; p < up_; ++p)
+		{
+			float* h = &coeffs_[static_cast<size_t>(p) * taps];
+			double sum = 0.0;
+
+			for (int j = 0; j < taps; ++j)
+			{
+				double x = j - center - static_cast<double>(p) / up_;
+				double r = x / half;
+				double window = std::abs(r) < 1.0 ? bessel_i0(beta * std::sqrt(1.0 - r * r)) / bessel_i0(beta) : 0.0;
+				double sinc = x == 0.0 ? 1.0 : std::sin(pi * cutoff * x) / (pi * cutoff * x);
+				h[j] = static_cast<float>(cutoff * sinc * window);
+				sum += h[j];
+			}
+
+			for (int j = 0; j < taps; ++j)
+				h[j] = static_cast<float>(h[j] / sum);
+		}
+	}
+
+	reset();
+	return true;
+}
+
+void resampler_t::reset()
+{
+	pos_ = 0;
+	history_.assign(channels_, std::vector<float>(taps - 1, 0.0f));
+}
+
+size_t resampler_t::max_output(size_t in_frames) const
+{
+	return (in_frames + taps) * up_ / down_ + 1;
+}
+
+size_t resampler_t::process(const float* const* in, size_t frames, float* const* out)
+{
+	if (passthrough())
+	{
+		for (int c = 0; c < channels_; ++c)
+			std::copy_n(in[c], frames, out[c]);
+		return frames;
+	}
+
+	const dsp_t& k = dsp();
+	const size_t keep = taps - 1;
+	const size_t total = keep + frames;
+
+	size_t produced = 0;
+	uint64_t pos = pos_;
+
+	for (int c = 0; c < channels_; ++c)
+	{
+		auto& buf = history_[c];
+		buf.resize(total);
+		std::copy_n(in[c], frames, buf.begin() + keep);
+
+		pos = pos_;
+		produced = 0;
+		while (pos / up_ + taps <= total)
+		{
+			const float* h = &coeffs_[static_cast<size_t>(pos % up_) * taps];
+			out[c][produced++] = k.dot_f32(&buf[static_cast<size_t>(pos / up_)], h, taps);
+			pos += down_;
+		}
+
+		std::copy(buf.end() - keep, buf.end(), buf.begin());
+		buf.resize(keep);
+	}
+
+	pos_ = pos - static_cast<uint64_t>(frames) * up_;
+	return produced;
+}
\ No newline at end of file
@@ -0,0 +1,38 @@
+#pragma once
+#ifndef _RESAMPLER_H_
+#define _RESAMPLER_H_
+
+#include "include.h"
+
+class resampler_t
+{
+public:
+	static constexpr int taps = 32;
+	static constexpr int max_phases = 4096;
+
+	bool init(int in_rate, int out_rate, int channels);
+	void reset();
+
+	bool passthrough() const { return up_ == down_; }
+	int in_rate() const { return in_rate_; }
+	int out_rate() const { return out_rate_; }
+	int channels() const { return channels_; }
+
+	size_t max_output(size_t in_frames) const;
+
+	// Planar in, planar out; `out` must hold max_output(frames) per channel.
+	size_t process(const float* const* in, size_t frames, float* const* out);
+
+private:
+	int in_rate_ = 0;
+	int out_rate_ = 0;
+	int channels_ = 0;
+	int up_ = 1;
+	int down_ = 1;
+
+	uint64_t pos_ = 0;
+	std::vector<float> coeffs_;
+	std::vector<std::vector<float>> history_;
+};
+
+#endif
\ No newline at end of file
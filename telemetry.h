@@ -0,0 +1,170 @@
+#pragma once
+#ifndef _TELEMETRY_H_
+#define _TELEMETRY_H_
+
+#include "include.h"
+
+// Log-linear histogram with 8 sub-buckets per power of two (about 12% resolution).
+// One writing thread per histogram; any thread may read while it is being written.
+class histogram_t
+{
+public:
+	static constexpr int sub_bits = 3;
+	static constexpr int sub_count = 1 << sub_bits;
+	static constexpr int bucket_count = (64 - sub_bits + 1) * sub_count;
+
+	void record(uint64_t v)
+	{
+		bump(counts_[bucket_of(v)], 1);
+		bump(count_, 1);
+		bump(sum_, v);
+		if (v > max_.load(std::memory_order_relaxed)) max_.store(v, std::memory_order_relaxed);
+	}
+
+	uint64_t count() const { return count_.load(std::memory_order_relaxed); }
+	uint64_t max() const { return max_.load(std::memory_order_relaxed); }
+	double mean() const
+	{
+		uint64_t n = count();
+		return n ? static_cast<double>(sum_.load(std::memory_order_relaxed)) / n : 0.0;
+	}
+
+	// Upper bound of the bucket holding the p-th percentile, p in [0, 1].
+	uint64_t percentile(double p) const
+	{
+		uint64_t n = count();
+		if (!n) return 0;
+
+		uint64_t rank = std::max<uint64_t>(1, static_cast<uint64_t>(std::ceil(p * n)));
+		uint64_t seen = 0;
+		for (int b = 0; b < bucket_count; ++b)
+		{
+			seen += counts_[b].load(std::memory_order_relaxed);
+			if (seen >= rank) return std::min(bucket_upper(b), max());
+		}
+		return max();
+	}
+
+private:
+	std::array<std::atomic<uint64_t>, bucket_count> counts_{};
+	std::atomic<uint64_t> count_{ 0 };
+	std::atomic<uint64_t> sum_{ 0 };
+	std::atomic<uint64_t> max_{ 0 };
+
+	// Single writer, so a plain load/store is enough and avoids a locked RMW on the hot path.
+	static void bump(std::atomic<uint64_t>& a, uint64_t v)
+	{
+		a.store(a.load(std::memory_order_relaxed) + v, std::memory_order_relaxed);
+	}
+
+	static int bucket_of(uint64_t v)
+	{
+		if (v < sub_count) return static_cast<int>(v);
+		int shift = 63 - std::countl_zero(v) - sub_bits;
+		return (shift + 1) * sub_count + static_cast<int>((v >> shift) & (sub_count - 1));
+	}
+
+	static uint64_t bucket_upper(int b)
+	{
+		if (b < sub_count) return static_cast<uint64_t>(b);
+		int shift = b / sub_count - 1;
+		uint64_t mantissa = sub_count + b % sub_count;
+		return ((mantissa + 1) << shift) - 1;
+	}
+};
+
+struct telemetry_t
+{
+	// Latencies in microseconds; each stage is recorded by exactly one thread.
+	enum stage_t
+	{
+		STAGE_READ,           // decode_video: sample view + NAL push
+		STAGE_DECODE,         // decode_video: de265_decode
+		STAGE_VQUEUE_PUSH,    // decode_video: blocked on a full video_frames
+		STAGE_AUDIO_DECODE,   // decode_audio: aacDecoder_Fill + DecodeFrame
+		STAGE_AUDIO_FILTER,   // decode_audio: mix, resample, interleave
+		STAGE_AQUEUE_PUSH,    // decode_audio: blocked on a full pcm / pcm_chunks
+		STAGE_VQUEUE_POP,     // render: blocked on an empty video_frames
+		STAGE_UPLOAD,         // render: texture lock + plane conversion
+		STAGE_PRESENT_WAIT,   // render: staged frame waiting for its deadline
+		STAGE_PRESENT,        // render: SDL_RenderPresent
+		STAGE_COUNT
+	};
+
+	enum depth_t
+	{
+		DEPTH_VIDEO_FRAMES,   // sampled by render after each pop
+		DEPTH_PCM_CHUNKS,     // sampled by decode_audio after each push
+		DEPTH_COUNT
+	};
+
+	static constexpr const char* stage_names[STAGE_COUNT] = {
+		"read", "decode", "vqueue push", "audio decode", "audio filter", "aqueue push",
+		"vqueue pop", "upload", "present wait", "present",
+	};
+
+	static constexpr const char* depth_names[DEPTH_COUNT] = { "video_frames", "pcm_chunks" };
+
+	std::array<histogram_t, STAGE_COUNT> stages;
+	std::array<histogram_t, DEPTH_COUNT> depths;
+
+	// |presented time - pts| in microseconds, and presents later than one refresh.
+	histogram_t av_offset;
+	std::atomic<uint64_t> late{ 0 };
+
+	// For intervals that do not fit a scope, such as a staged frame waiting for its deadline.
+	void record_since(stage_t stage, std::chrono::steady_clock::time_point start)
+	{
+		g_trace()->span(stage_names[stage], start);
+		auto us = std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::steady_clock::now() - start).count();
+		stages[stage].record(static_cast<uint64_t>(std::max<int64_t>(us, 0)));
+	}
+
+	void print() const
+	{
+		auto row = [](const char* name, const histogram_t& h)
+			{
+				printf("  %-14s %8llu %9.0f %8llu %8llu %8llu %8llu\n", name,
+					static_cast<unsigned long long>(h.count()), h.mean(),
+					static_cast<unsigned long long>(h.percentile(0.5)),
+					static_cast<unsigned long long>(h.percentile(0.9)),
+					static_cast<unsigned long long>(h.percentile(0.99)),
+					static_cast<unsigned long long>(h.max()));
+			};
+
+		printf("telemetry:        count      mean      p50      p90      p99      max\n");
+		for (int s = 0; s < STAGE_COUNT; ++s)
+			row(stage_names[s], stages[s]);
+		row("a/v offset", av_offset);
+		for (int d = 0; d < DEPTH_COUNT; ++d)
+			row(depth_names[d], depths[d]);
+	}
+};
+
+// Records a stage latency, and the matching begin/end pair when tracing is on.
+class stage_timer_t
+{
+public:
+	stage_timer_t(telemetry_t& telemetry, telemetry_t::stage_t stage)
+		: h_(telemetry.stages[stage]), name_(telemetry_t::stage_names[stage]), start_(std::chrono::steady_clock::now())
+	{
+		g_trace()->begin(name_);
+	}
+
+	~stage_timer_t()
+	{
+		g_trace()->end(name_);
+		auto us = std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::steady_clock::now() - start_).count();
+		h_.record(static_cast<uint64_t>(std::max<int64_t>(us, 0)));
+	}
+
+	stage_timer_t(const stage_timer_t&) = delete;
+	stage_timer_t& operator=(const stage_timer_t&) = delete;
+
+private:
+	histogram_t& h_;
+	const char* name_;
+	std::chrono::steady_clock::time_point start_;
+};
+
+#endif
\ No newline at end of file
@@ -0,0 +1,209 @@
+#define MPLAYER_HEADLESS
+#include "include.h"
+#include <random>
+
+// Every kernel at every level this CPU supports must match the scalar level bit for bit
+// (dot_f32 within rounding) over all lengths up to max_len, so the SIMD tail loops are covered.
+static constexpr size_t max_len = 300;
+static constexpr size_t offset = 1;
+
+static std::mt19937 rng(12345);
+static int failures = 0;
+
+static void fail(const char* level, const char* kernel, size_t n, const char* what)
+{
+	if (++failures <= 20)
+		printf("%s %s: mismatch at length %zu (%s)\n", level, kernel, n, what);
+}
+
+template<typename T>
+static std::vector<T> random_vector(size_t n, T lo, T hi)
+{
+	std::uniform_int_distribution<int64_t> dis(lo, hi);
+	std::vector<T> v(n);
+	for (auto& x : v) x = static_cast<T>(dis(rng));
+	return v;
+}
+
+// Random data with the extremes sprinkled in, to hit the saturating paths.
+static std::vector<int16_t> s16_input(size_t n)
+{
+	auto v = random_vector<int16_t>(n, INT16_MIN, INT16_MAX);
+	for (size_t i = 0; i < n; i += 7) v[i] = (i / 7) & 1 ? INT16_MAX : INT16_MIN;
+	return v;
+}
+
+static std::vector<uint16_t> u16_input(size_t n, uint16_t hi)
+{
+	auto v = random_vector<uint16_t>(n, 0, hi);
+	for (size_t i = 0; i < n; i += 5) v[i] = (i / 5) & 1 ? hi : 0;
+	return v;
+}
+
+static std::vector<float> f32_input(size_t n, float range)
+{
+	std::uniform_real_distribution<float> dis(-range, range);
+	std::vector<float> v(n);
+	for (auto& x : v) x = dis(rng);
+	static const float specials[] = { 0.0f, -0.0f, 1.0f, -1.0f, 1e30f, -1e30f,
+		std::numeric_limits<float>::infinity(), -std::numeric_limits<float>::infinity(), std::nanf("") };
+	for (size_t i = 0; i < n; i += 11) v[i] = specials[(i / 11) % std::size(specials)];
+	return v;
+}
+
+static bool same_bits(const float* a, const float* b, size_t n)
+{
+	return !n || !memcmp(a, b, n * sizeof(float));
+}
+
+static void test_level(const dsp_t& s, const dsp_t& k)
+{
+	for (size_t n = 0; n <= max_len; ++n)
+	{
+		// Inputs start one element in so the SIMD paths also see unaligned pointers.
+		{
+			auto in = s16_input(n + offset);
+			for (float gain : { 0.5f, 1.0f, 3.0f, -2.0f })
+			{
+				auto a = in, b = in;
+				s.gain_s16(a.data() + offset, n, gain);
+				k.gain_s16(b.data() + offset, n, gain);
+				if (a != b) fail(k.name, "gain_s16", n, "s16");
+			}
+		}
+		{
+			auto in = f32_input(n + offset, 2.0f);
+			std::vector<int16_t> a(n), b(n);
+			s.f32_to_s16(in.data() + offset, a.data(), n);
+			k.f32_to_s16(in.data() + offset, b.data(), n);
+			if (a != b) fail(k.name, "f32_to_s16", n, "s16");
+		}
+		{
+			auto in = s16_input(2 * n + offset);
+			std::vector<int16_t> a(n), b(n);
+			s.downmix_s16(in.data() + offset, a.data(), n);
+			k.downmix_s16(in.data() + offset, b.data(), n);
+			if (a != b) fail(k.name, "downmix_s16", n, "s16");
+
+			std::vector<int16_t> c(2 * n), d(2 * n);
+			s.upmix_s16(in.data() + offset, c.data(), n);
+			k.upmix_s16(in.data() + offset, d.data(), n);
+			if (c != d) fail(k.name, "upmix_s16", n, "s16");
+
+			std::vector<float> l1(n), r1(n), l2(n), r2(n);
+			s.deinterleave_s16(in.data() + offset, l1.data(), r1.data(), n);
+			k.deinterleave_s16(in.data() + offset, l2.data(), r2.data(), n);
+			if (!same_bits(l1.data(), l2.data(), n) || !same_bits(r1.data(), r2.data(), n)) fail(k.name, "deinterleave_s16", n, "f32");
+		}
+		{
+			auto l = f32_input(n + offset, 1.0f), r = f32_input(n + offset, 1.0f);
+			std::vector<float> a(2 * n), b(2 * n);
+			s.interleave_f32(l.data() + offset, r.data() + offset, a.data(), n);
+			k.interleave_f32(l.data() + offset, r.data() + offset, b.data(), n);
+			if (!same_bits(a.data(), b.data(), 2 * n)) fail(k.name, "interleave_f32", n, "f32");
+		}
+		{
+			auto in = f32_input(n + offset, 4.0f);
+			for (float gain : { 0.25f, 1.0f, 8.0f })
+			{
+				auto a = in, b = in;
+				s.gain_f32(a.data() + offset, n, gain);
+				k.gain_f32(b.data() + offset, n, gain);
+				if (!same_bits(a.data(), b.data(), a.size())) fail(k.name, "gain_f32", n, "f32");
+			}
+		}
+		{
+			auto a = f32_input(n + offset, 1.0f), b = f32_input(n + offset, 1.0f);
+			for (size_t i = 0; i < a.size(); ++i)
+			{
+				if (!std::isfinite(a[i])) a[i] = 0.5f;
+				a[i] = std::clamp(a[i], -1.0f, 1.0f);
+				if (!std::isfinite(b[i])) b[i] = -0.5f;
+				b[i] = std::clamp(b[i], -1.0f, 1.0f);
+			}
+			float x = s.dot_f32(a.data() + offset, b.data() + offset, n);
+			float y = k.dot_f32(a.data() + offset, b.data() + offset, n);
+			if (std::fabs(x - y) > 1e-4f * (1.0f + static_cast<float>(n))) fail(k.name, "dot_f32", n, "sum");
+		}
+		{
+			auto u = random_vector<uint8_t>(n + offset, 0, 255), v = random_vector<uint8_t>(n + offset, 0, 255);
+			std::vector<uint8_t> a(2 * n), b(2 * n);
+			s.interleave_u8(u.data() + offset, v.data() + offset, a.data(), n);
+			k.interleave_u8(u.data() + offset, v.data() + offset, b.data(), n);
+			if (a != b) fail(k.name, "interleave_u8", n, "u8");
+
+			std::vector<uint8_t> c(n), d(n);
+			s.avg_rows_u8(u.data() + offset, v.data() + offset, c.data(), n);
+			k.avg_rows_u8(u.data() + offset, v.data() + offset, d.data(), n);
+			if (c != d) fail(k.name, "avg_rows_u8", n, "u8");
+		}
+		{
+			auto ra = random_vector<uint8_t>(2 * n + offset, 0, 255), rb = random_vector<uint8_t>(2 * n + offset, 0, 255);
+			for (size_t i = 0; i < ra.size(); i += 3) ra[i] = rb[i] = 255;
+			std::vector<uint8_t> a(n), b(n);
+			s.downsample_2x2_u8(ra.data() + offset, rb.data() + offset, a.data(), n);
+			k.downsample_2x2_u8(ra.data() + offset, rb.data() + offset, b.data(), n);
+			if (a != b) fail(k.name, "downsample_2x2_u8", n, "u8");
+		}
+		for (int bits : { 10, 12, 16 })
+		{
+			uint16_t hi = static_cast<uint16_t>((1u << bits) - 1);
+			auto u = u16_input(n + offset, hi), v = u16_input(n + offset, hi);
+
+			for (int shift = 0; shift <= 16 - bits; ++shift)
+			{
+				std::vector<uint16_t> a(2 * n), b(2 * n);
+				s.interleave_u16(u.data() + offset, v.data() + offset, a.data(), n, shift);
+				k.interleave_u16(u.data() + offset, v.data() + offset, b.data(), n, shift);
+				if (a != b) fail(k.name, "interleave_u16", n, "u16");
+
+				std::vector<uint16_t> c(n), d(n);
+				s.shl_u16(u.data() + offset, c.data(), n, shift);
+				k.shl_u16(u.data() + offset, d.data(), n, shift);
+				if (c != d) fail(k.name, "shl_u16", n, "u16");
+			}
+
+			for (int shift = 1; shift <= std::min(bits - 8, 8); ++shift)
+			{
+				auto dither = random_vector<uint16_t>(16, 0, static_cast<uint16_t>((1u << shift) - 1));
+				std::vector<uint8_t> a(n), b(n);
+				s.u16_to_u8(u.data() + offset, a.data(), n, shift, dither.data());
+				k.u16_to_u8(u.data() + offset, b.data(), n, shift, dither.data());
+				if (a != b) fail(k.name, "u16_to_u8", n, "u8");
+			}
+
+			std::vector<uint16_t> c(n), d(n);
+			s.avg_rows_u16(u.data() + offset, v.data() + offset, c.data(), n);
+			k.avg_rows_u16(u.data() + offset, v.data() + offset, d.data(), n);
+			if (c != d) fail(k.name, "avg_rows_u16", n, "u16");
+
+			auto ra = u16_input(2 * n + offset, hi), rb = u16_input(2 * n + offset, hi);
+			std::vector<uint16_t> e(n), f(n);
+			s.downsample_2x2_u16(ra.data() + offset, rb.data() + offset, e.data(), n);
+			k.downsample_2x2_u16(ra.data() + offset, rb.data() + offset, f.data(), n);
+			if (e != f) fail(k.name, "downsample_2x2_u16", n, "u16");
+		}
+	}
+}
+
+int main()
+{
+	const dsp_t* scalar = dsp_kernels(DSP_SCALAR);
+	int tested = 0;
+
+	for (int level = DSP_SCALAR + 1; level < DSP_LEVELS; ++level)
+	{
+		const dsp_t* k = dsp_kernels(static_cast<dsp_level_t>(level));
+		if (!k) continue;
+
+		int before = failures;
+		test_level(*scalar, *k);
+		printf("%-8s %s\n", k->name, failures == before ? "ok" : "FAILED");
+		++tested;
+	}
+
+	if (!tested)
+		printf("no SIMD level supported, nothing to compare\n");
+
+	return failures ? 1 : 0;
+}
\ No newline at end of file
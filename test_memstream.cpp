@@ -0,0 +1,47 @@
+#define MPLAYER_HEADLESS
+#include "include.h"
+
+// Opens several encrypted items with one password vector, the way load_media does for a playlist.
+int main()
+{
+	const std::vector<char> password = { 'z', '1', 'x', '2', 'c', '3', 'v', '4', 'b', '5', 'n', '6' };
+	std::vector<char> shared = password;
+	const auto key = g_cryptor()->sha256(password);
+
+	auto dir = std::filesystem::temp_directory_path();
+	int failures = 0;
+
+	for (int item = 0; item < 3; ++item)
+	{
+		std::vector<uint8_t> plain(4096 + item * 37);
+		for (size_t i = 0; i < plain.size(); ++i)
+			plain[i] = static_cast<uint8_t>(i * 31 + item);
+
+		auto encrypted = g_cryptor()->encrypt_bin(plain, key);
+		auto path = dir / ("mplayer_test_memstream_" + std::to_string(item) + ".bin");
+		{
+			std::ofstream out(path, std::ios::binary | std::ios::trunc);
+			out.write(reinterpret_cast<const char*>(encrypted.data()), static_cast<std::streamsize>(encrypted.size()));
+		}
+
+		memstream_t stream(path, shared);
+		auto view = stream.view(0, plain.size());
+		bool ok = stream.is_valid() && stream.size() == plain.size() && std::equal(view.begin(), view.end(), plain.begin());
+		std::filesystem::remove(path);
+
+		if (!ok)
+		{
+			printf("item %d: decrypt failed\n", item);
+			++failures;
+		}
+	}
+
+	if (shared != password)
+	{
+		printf("caller's password was modified\n");
+		++failures;
+	}
+
+	printf("memstream: %s\n", failures ? "FAILED" : "ok");
+	return failures ? 1 : 0;
+}
\ No newline at end of file
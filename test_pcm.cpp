@@ -0,0 +1,132 @@
+#define MPLAYER_HEADLESS
+#include "include.h"
+#include "alloccount.h"
+
+// Feeds decoded PCM through audio_sink_t into the player's PCM ring and drains it the way the audio
+// callback does. Once warmed up, this path must not allocate.
+static bool run(int in_rate, int in_channels, int out_rate, int out_channels)
+{
+	const uint64_t warmup = 16;
+	const uint64_t measured = 2000;
+
+	auto mpctx = std::make_unique<player_t>();
+	mpctx->output_rate = out_rate;
+	mpctx->output_channels = out_channels;
+	mpctx->state.store(player_t::PLAYING);
+
+	CStreamInfo info{};
+	info.sampleRate = in_rate;
+	info.numChannels = in_channels;
+	info.frameSize = 1024;
+
+	std::vector<int16_t> pcm(player_t::pcm_chunk_t::max_samples);
+	for (size_t i = 0; i < pcm.size(); ++i)
+		pcm[i] = static_cast<int16_t>((i * 7919) & 0xFFFF);
+
+	audio_sink_t sink;
+	player_t::pcm_chunk_t chunk{};
+	float block[1024];
+	uint64_t warm_allocs = 0, samples = 0;
+
+	alloc_scope_t allocs;
+	for (uint64_t frame = 0; frame < warmup + measured; ++frame)
+	{
+		if (frame == warmup) warm_allocs = allocs.allocs();
+
+		if (!sink.push(mpctx.get(), pcm.data(), &info, frame * 1024 * 1000 / in_rate, 0))
+		{
+			printf("%d Hz x%d -> %d Hz x%d: push failed\n", in_rate, in_channels, out_rate, out_channels);
+			return false;
+		}
+
+		while (mpctx->pcm_chunks.try_pop(chunk))
+		{
+			for (size_t left = chunk.samples; left > 0;)
+			{
+				size_t n = mpctx->pcm.read(block, std::min(left, std::size(block) / chunk.channels * chunk.channels));
+				if (!n) break;
+
+				dsp().gain_f32(block, n, 0.5f);
+				left -= n;
+				samples += n;
+			}
+		}
+	}
+
+	uint64_t steady = allocs.allocs() - warm_allocs;
+	printf("%d Hz x%d -> %d Hz x%d: %llu samples out, %llu allocations after warmup\n", in_rate, in_channels, out_rate, out_channels,
+		static_cast<unsigned long long>(samples), static_cast<unsigned long long>(steady));
+
+	return steady == 0 && samples > 0;
+}
+
+// An 8 kHz four-channel frame upsampled to 48 kHz is larger than the whole ring. It has to arrive in pieces that
+// each fit, in order, rather than blocking the decoder forever.
+static bool run_oversized()
+{
+	const int frames = 8;
+
+	auto mpctx = std::make_unique<player_t>();
+	mpctx->output_rate = 48000;
+	mpctx->output_channels = 4;
+	mpctx->state.store(player_t::PLAYING);
+
+	CStreamInfo info{};
+	info.sampleRate = 8000;
+	info.numChannels = 4;
+	info.frameSize = player_t::pcm_chunk_t::max_frames;
+
+	std::vector<int16_t> pcm(player_t::pcm_chunk_t::max_samples, 1000);
+
+	size_t samples = 0, largest = 0;
+	bool ordered = true;
+
+	std::thread consumer([&]()
+		{
+			player_t::pcm_chunk_t chunk;
+			uint64_t last_pts = 0;
+			float block[1024];
+
+			while (mpctx->pcm_chunks.pop(chunk))
+			{
+				ordered = ordered && chunk.pts >= last_pts;
+				last_pts = chunk.pts;
+				largest = std::max(largest, chunk.samples);
+
+				for (size_t left = chunk.samples; left > 0;)
+				{
+					size_t n = mpctx->pcm.read(block, std::min(left, std::size(block)));
+					if (!n) break;
+					left -= n;
+					samples += n;
+				}
+			}
+		});
+
+	audio_sink_t sink;
+	bool pushed = true;
+	for (int frame = 0; frame < frames && pushed; ++frame)
+		pushed = sink.push(mpctx.get(), pcm.data(), &info, frame * player_t::pcm_chunk_t::max_frames * 1000 / 8000, 0);
+
+	mpctx->set_state(player_t::STOPPED);
+	consumer.join();
+
+	const size_t ring = decltype(mpctx->pcm)::max_size;
+	printf("8000 Hz x4 -> 48000 Hz x4: %zu samples out, largest chunk %zu of a %zu-sample ring\n", samples, largest, ring);
+
+	return pushed && ordered && largest <= ring && samples > frames * ring;
+}
+
+int main()
+{
+	int failures = 0;
+
+	if (!run(44100, 2, 48000, 2)) ++failures;
+	if (!run(48000, 2, 48000, 2)) ++failures;
+	if (!run(48000, 1, 48000, 2)) ++failures;
+	if (!run(22050, 2, 48000, 1)) ++failures;
+	if (!run_oversized()) ++failures;
+
+	printf("pcm: %s\n", failures ? "FAILED" : "ok");
+	return failures ? 1 : 0;
+}
\ No newline at end of file
@@ -0,0 +1,111 @@
+#include "include.h"
+
+bool trace_t::start(const std::filesystem::path& path)
+{
+	std::lock_guard<std::mutex> lock(mtx_);
+	if (enabled()) return false;
+
+	path_ = path;
+	epoch_ = std::chrono::steady_clock::now();
+	enabled_.store(true);
+	return true;
+}
+
+trace_t::buffer_t* trace_t::local()
+{
+	thread_local buffer_t* buffer = 0;
+	if (buffer) return buffer;
+
+	std::lock_guard<std::mutex> lock(mtx_);
+	buffers_.push_back(std::make_unique<buffer_t>());
+	buffer = buffers_.back().get();
+	buffer->tid = static_cast<int>(buffers_.size());
+	buffer->name = "thread " + std::to_string(buffer->tid);
+	return buffer;
+}
+
+void trace_t::append(const char* name, char phase, std::chrono::steady_clock::time_point at)
+{
+	buffer_t* buffer = local();
+
+	size_t n = buffer->size.load(std::memory_order_relaxed);
+	if (n >= events_per_thread)
+	{
+		buffer->dropped.fetch_add(1, std::memory_order_relaxed);
+		return;
+	}
+
+	auto ns = std::chrono::duration_cast<std::chrono::nanoseconds>(at - epoch_).count();
+	buffer->events[n] = { name, ns, phase };
+	buffer->size.store(n + 1, std::memory_order_release);
+}
+
+void trace_t::name_thread(const char* name)
+{
+	if (!enabled()) return;
+
+	buffer_t* buffer = local();
+	if (buffer->named) return;
+
+	std::lock_guard<std::mutex> lock(mtx_);
+	buffer->name = name;
+	buffer->named = true;
+}
+
+static void write_json_string(std::ofstream& out, const std::string& s)
+{
+	out << '"';
+	for (char c : s)
+	{
+		if (c == '"' || c == '\\') out << '\\' << c;
+		else if (static_cast<unsigned char>(c) < 0x20) out << ' ';
+		else out << c;
+	}
+	out << '"';
+}
+
+bool trace_t::write()
+{
+	if (!enabled()) return false;
+	enabled_.store(false);
+
+	std::ofstream out(path_, std::ios::binary | std::ios::trunc);
+	if (!out) return false;
+
+	std::lock_guard<std::mutex> lock(mtx_);
+
+	out << "{\"displayTimeUnit\":\"ms\",\"traceEvents\":[\n";
+	out << "{\"name\":\"process_name\",\"ph\":\"M\",\"pid\":1,\"tid\":0,\"args\":{\"name\":\"mplayer\"}}";
+
+	char ts[32];
+	uint64_t total = 0, dropped = 0;
+
+	for (const auto& buffer : buffers_)
+	{
+		out << ",\n{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":1,\"tid\":" << buffer->tid << ",\"args\":{\"name\":";
+		write_json_string(out, buffer->name);
+		out << "}}";
+
+		size_t n = buffer->size.load(std::memory_order_acquire);
+		for (size_t i = 0; i < n; ++i)
+		{
+			const event_t& e = buffer->events[i];
+			snprintf(ts, sizeof(ts), "%.3f", e.ns / 1000.0);
+
+			out << ",\n{\"name\":";
+			write_json_string(out, e.name);
+			out << ",\"ph\":\"" << e.phase << "\",\"ts\":" << ts << ",\"pid\":1,\"tid\":" << buffer->tid;
+			if (e.phase == 'i') out << ",\"s\":\"t\"";
+			out << '}';
+		}
+
+		total += n;
+		dropped += buffer->dropped.load(std::memory_order_relaxed);
+	}
+
+	out << "\n]}\n";
+
+	printf("trace: %llu events, %llu dropped, %zu threads\n",
+		static_cast<unsigned long long>(total), static_cast<unsigned long long>(dropped), buffers_.size());
+	return out.good();
+}
\ No newline at end of file
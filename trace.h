@@ -0,0 +1,82 @@
+#pragma once
+#ifndef _TRACE_H_
+#define _TRACE_H_
+
+#include "include.h"
+
+// Chrome trace event recorder (chrome://tracing, ui.perfetto.dev).
+// Each thread appends to its own fixed-size buffer without locking; the file is written once at exit.
+class trace_t
+{
+public:
+	static constexpr size_t events_per_thread = 1 << 18;
+
+	bool start(const std::filesystem::path& path);
+	bool enabled() const { return enabled_.load(std::memory_order_acquire); }
+
+	void begin(const char* name) { if (enabled()) append(name, 'B', std::chrono::steady_clock::now()); }
+	void end(const char* name) { if (enabled()) append(name, 'E', std::chrono::steady_clock::now()); }
+	void instant(const char* name) { if (enabled()) append(name, 'i', std::chrono::steady_clock::now()); }
+
+	// An interval that started at `start` and ends now.
+	void span(const char* name, std::chrono::steady_clock::time_point start)
+	{
+		if (!enabled()) return;
+		append(name, 'B', start);
+		append(name, 'E', std::chrono::steady_clock::now());
+	}
+
+	// Names the calling thread in the trace; only the first call per thread counts.
+	void name_thread(const char* name);
+
+	bool write();
+
+private:
+	struct event_t
+	{
+		const char* name;
+		int64_t ns;
+		char phase;
+	};
+
+	struct buffer_t
+	{
+		int tid = 0;
+		std::string name;
+		bool named = false;
+		std::unique_ptr<event_t[]> events = std::make_unique<event_t[]>(events_per_thread);
+		std::atomic<size_t> size{ 0 };
+		std::atomic<uint64_t> dropped{ 0 };
+	};
+
+	std::atomic<bool> enabled_{ false };
+	std::filesystem::path path_;
+	std::chrono::steady_clock::time_point epoch_;
+
+	std::mutex mtx_;
+	std::vector<std::unique_ptr<buffer_t>> buffers_;
+
+	buffer_t* local();
+	void append(const char* name, char phase, std::chrono::steady_clock::time_point at);
+};
+
+inline trace_t* g_trace()
+{
+	static trace_t trace;
+	return &trace;
+}
+
+class trace_scope_t
+{
+public:
+	explicit trace_scope_t(const char* name) : name_(name) { g_trace()->begin(name_); }
+	~trace_scope_t() { g_trace()->end(name_); }
+
+	trace_scope_t(const trace_scope_t&) = delete;
+	trace_scope_t& operator=(const trace_scope_t&) = delete;
+
+private:
+	const char* name_;
+};
+
+#endif
\ No newline at end of file
@@ -1,182 +1,371 @@
-#pragma once
-#pragma once
-#ifndef _UTILS_H_
-#define _UTILS_H_
-
-#include "include.h"
-
-template<typename T, size_t capacity = 0>
-class safe_queue {
-    std::queue<T> q;
-    mutable std::mutex mtx;
-    std::condition_variable cv_push;
-    std::condition_variable cv_pop;
-    std::atomic<bool> shutdown_flag{ false };
-    std::atomic<bool> draining_flag{ false };
-
-    static constexpr bool has_capacity = (capacity > 0);
-
-public:
-    safe_queue() = default;
-    ~safe_queue() { shutdown(); }
-
-    safe_queue(const safe_queue&) = delete;
-    safe_queue& operator=(const safe_queue&) = delete;
-
-    void push(T&& value)
-    {
-        std::unique_lock<std::mutex> lock(mtx);
-        if constexpr (has_capacity) {
-            cv_push.wait(lock, [&]() {
-                return q.size() < capacity || shutdown_flag.load() || draining_flag.load();
-                });
-            if (shutdown_flag.load() || draining_flag.load()) return;
-        }
-        q.push(std::move(value));
-        cv_pop.notify_one();
-    }
-
-    bool pop(T& result)
-    {
-        std::unique_lock<std::mutex> lock(mtx);
-        cv_pop.wait(lock, [&]() {
-            return !q.empty() || shutdown_flag.load();
-            });
-
-        if (shutdown_flag && q.empty()) return false;
-
-        result = std::move(q.front());
-        q.pop();
-        if constexpr (has_capacity) cv_push.notify_one();
-        return true;
-    }
-
-    size_t size() const
-    {
-        std::lock_guard<std::mutex> lock(mtx);
-        return q.size();
-    }
-
-    void drain()
-    {
-        {
-            std::lock_guard<std::mutex> lock(mtx);
-            draining_flag.store(true);
-            std::queue<T> empty;
-            std::swap(q, empty);
-        }
-        cv_push.notify_all();
-        draining_flag.store(false);
-    }
-
-    void shutdown() noexcept
-    {
-        shutdown_flag.store(true);
-        cv_push.notify_all();
-        cv_pop.notify_all();
-    }
-
-    safe_queue(safe_queue&& other) noexcept
-    {
-        std::scoped_lock lock(other.mtx);
-        q = std::move(other.q);
-        shutdown_flag.store(other.shutdown_flag.load());
-        draining_flag.store(other.draining_flag.load());
-    }
-
-    safe_queue& operator=(safe_queue&& other) noexcept
-    {
-        if (this != &other)
-        {
-            std::scoped_lock lock(mtx, other.mtx);
-            q = std::move(other.q);
-            shutdown_flag.store(other.shutdown_flag.load());
-            draining_flag.store(other.draining_flag.load());
-        }
-        return *this;
-    }
-};
-
-class button_t
-{
-private:
-	int vk_code;
-	int delay;
-	std::chrono::steady_clock::time_point last_time;
-
-public:
-	button_t(int keyCode, int ms) : vk_code(keyCode), delay(ms),
-		last_time(std::chrono::steady_clock::now() - std::chrono::milliseconds(ms)) {
-	}
-
-	bool is_pressed()
-	{
-		if (GetAsyncKeyState(vk_code) & 0x8000)
-		{
-			auto now = std::chrono::steady_clock::now();
-			auto elapsed = std::chrono::duration_cast<std::chrono::milliseconds>(now - last_time);
-			if (elapsed.count() >= delay)
-			{
-				last_time = now;
-				return true;
-			}
-		}
-		return false;
-	}
-};
-
-inline uint16_t bswap16(uint16_t x)
-{
-	return ((x & 0xFF00) >> 8) |
-		((x & 0x00FF) << 8);
-}
-
-inline uint32_t bswap32(uint32_t x)
-{
-	return ((x & 0xFF000000) >> 24) |
-		((x & 0x00FF0000) >> 8) |
-		((x & 0x0000FF00) << 8) |
-		((x & 0x000000FF) << 24);
-}
-
-inline bool is_valid_atom_type(const char* type_buf)
-{
-	for (int i = 0; i < 4; ++i)
-	{
-		unsigned char c = static_cast<unsigned char>(type_buf[i]);
-		if (c < 32 || c > 126) return false;
-	}
-	return true;
-}
-
-inline void zclear_console()
-{
-	HANDLE h = GetStdHandle(STD_OUTPUT_HANDLE);
-	CONSOLE_SCREEN_BUFFER_INFO csbi;
-	DWORD written;
-	GetConsoleScreenBufferInfo(h, &csbi);
-	DWORD size = csbi.dwSize.X * csbi.dwSize.Y;
-	FillConsoleOutputCharacter(h, ' ', size, { 0, 0 }, &written);
-	FillConsoleOutputAttribute(h, csbi.wAttributes, size, { 0, 0 }, &written);
-	SetConsoleCursorPosition(h, { 0, 0 });
-}
-
-inline bool read_password(std::vector<char>& password)
-{
-	HANDLE hi = GetStdHandle(STD_INPUT_HANDLE);
-	if (hi == INVALID_HANDLE_VALUE) return false;
-
-	DWORD br = 0;
-	char data[256] = { 0 };
-
-	if (!ReadFile(hi, data, 255, &br, NULL)) return false;
-
-	while (br && (data[br - 1] == '\n' || data[br - 1] == '\r'))
-		data[--br] = '\0';
-
-	password.assign(data, data + br);
-	SecureZeroMemory(data, sizeof(data));
-	return true;
-}
-
+#pragma once
+#pragma once
+#ifndef _UTILS_H_
+#define _UTILS_H_
+
+#include "include.h"
+
+template<typename T, size_t capacity = 0>
+class safe_queue {
+    std::queue<T> q;
+    mutable std::mutex mtx;
+    std::condition_variable cv_push;
+    std::condition_variable cv_pop;
+    std::atomic<bool> shutdown_flag{ false };
+    std::atomic<bool> draining_flag{ false };
+
+    static constexpr bool has_capacity = (capacity > 0);
+
+public:
+    safe_queue() = default;
+    ~safe_queue() { shutdown(); }
+
+    safe_queue(const safe_queue&) = delete;
+    safe_queue& operator=(const safe_queue&) = delete;
+
+    void push(T&& value)
+    {
+        std::unique_lock<std::mutex> lock(mtx);
+        if constexpr (has_capacity) {
+            cv_push.wait(lock, [&]() {
+                return q.size() < capacity || shutdown_flag.load() || draining_flag.load();
+                });
+            if (shutdown_flag.load() || draining_flag.load()) return;
+        }
+        q.push(std::move(value));
+        cv_pop.notify_one();
+    }
+
+    bool pop(T& result)
+    {
+        std::unique_lock<std::mutex> lock(mtx);
+        cv_pop.wait(lock, [&]() {
+            return !q.empty() || shutdown_flag.load();
+            });
+
+        if (shutdown_flag && q.empty()) return false;
+
+        result = std::move(q.front());
+        q.pop();
+        if constexpr (has_capacity) cv_push.notify_one();
+        return true;
+    }
+
+    size_t size() const
+    {
+        std::lock_guard<std::mutex> lock(mtx);
+        return q.size();
+    }
+
+    void drain()
+    {
+        {
+            std::lock_guard<std::mutex> lock(mtx);
+            draining_flag.store(true);
+            std::queue<T> empty;
+            std::swap(q, empty);
+        }
+        cv_push.notify_all();
+        draining_flag.store(false);
+    }
+
+    void shutdown() noexcept
+    {
+        shutdown_flag.store(true);
+        cv_push.notify_all();
+        cv_pop.notify_all();
+    }
+
+    safe_queue(safe_queue&& other) noexcept
+    {
+        std::scoped_lock lock(other.mtx);
+        q = std::move(other.q);
+        shutdown_flag.store(other.shutdown_flag.load());
+        draining_flag.store(other.draining_flag.load());
+    }
+
+    safe_queue& operator=(safe_queue&& other) noexcept
+    {
+        if (this != &other)
+        {
+            std::scoped_lock lock(mtx, other.mtx);
+            q = std::move(other.q);
+            shutdown_flag.store(other.shutdown_flag.load());
+            draining_flag.store(other.draining_flag.load());
+        }
+        return *this;
+    }
+};
+
+template<typename T, size_t capacity>
+class spsc_ring {
+    static_assert(capacity > 0, "spsc_ring needs a fixed capacity");
+
+    std::array<T, capacity> slots;
+
+    alignas(64) std::atomic<size_t> head{ 0 };
+    alignas(64) std::atomic<size_t> tail{ 0 };
+
+    alignas(64) std::atomic<uint32_t> data_seq{ 0 };
+    std::atomic<uint32_t> space_seq{ 0 };
+    std::atomic<bool> consumer_waiting{ false };
+    std::atomic<bool> producer_waiting{ false };
+
+    std::atomic<size_t> drain_to{ 0 };
+    std::atomic<uint32_t> drain_epoch{ 0 };
+    std::atomic<bool> shutdown_flag{ false };
+
+    static void wake(std::atomic<uint32_t>& seq)
+    {
+        seq.fetch_add(1);
+        seq.notify_one();
+    }
+
+    // Consumer side: discards everything that was queued when drain() was called.
+    void apply_drain(size_t& h)
+    {
+        size_t d = drain_to.load(std::memory_order_acquire);
+        if (d <= h) return;
+
+        for (; h < d; ++h) slots[h % capacity] = T{};
+        head.store(h);
+        if (producer_waiting.exchange(false)) wake(space_seq);
+    }
+
+public:
+    spsc_ring() = default;
+    ~spsc_ring() { shutdown(); }
+
+    spsc_ring(const spsc_ring&) = delete;
+    spsc_ring& operator=(const spsc_ring&) = delete;
+
+    bool try_push(T&& value)
+    {
+        size_t t = tail.load(std::memory_order_relaxed);
+        if (t - head.load(std::memory_order_acquire) >= capacity) return false;
+
+        slots[t % capacity] = std::move(value);
+        tail.store(t + 1);
+        if (consumer_waiting.exchange(false)) wake(data_seq);
+        return true;
+    }
+
+    bool push(T&& value)
+    {
+        uint32_t epoch = drain_epoch.load();
+        while (true)
+        {
+            if (try_push(std::move(value))) return true;
+
+            uint32_t seq = space_seq.load();
+            producer_waiting.store(true);
+            if (shutdown_flag.load() || drain_epoch.load() != epoch)
+            {
+                producer_waiting.store(false);
+                return false;
+            }
+            if (tail.load(std::memory_order_relaxed) - head.load() >= capacity)
+                space_seq.wait(seq);
+            producer_waiting.store(false);
+        }
+    }
+
+    bool try_pop(T& result)
+    {
+        size_t h = head.load(std::memory_order_relaxed);
+        apply_drain(h);
+        if (h == tail.load(std::memory_order_acquire)) return false;
+
+        result = std::move(slots[h % capacity]);
+        head.store(h + 1);
+        if (producer_waiting.exchange(false)) wake(space_seq);
+        return true;
+    }
+
+    bool pop(T& result)
+    {
+        return pop(result, []() { return false; });
+    }
+
+    // Consumer side. Also gives up once stop() holds; wake_consumer() makes it re-check.
+    template<typename Pred>
+    bool pop(T& result, Pred stop)
+    {
+        while (true)
+        {
+            if (try_pop(result)) return true;
+
+            uint32_t seq = data_seq.load();
+            consumer_waiting.store(true);
+            if (shutdown_flag.load())
+            {
+                consumer_waiting.store(false);
+                return try_pop(result);
+            }
+            if (stop())
+            {
+                consumer_waiting.store(false);
+                return false;
+            }
+            size_t h = head.load(std::memory_order_relaxed);
+            if (h == tail.load() && drain_to.load() <= h)
+                data_seq.wait(seq);
+            consumer_waiting.store(false);
+        }
+    }
+
+    size_t size() const
+    {
+        size_t h = std::max(head.load(), drain_to.load());
+        size_t t = tail.load();
+        return t > h ? t - h : 0;
+    }
+
+    void wake_consumer()
+    {
+        wake(data_seq);
+    }
+
+    void drain()
+    {
+        drain_to.store(tail.load());
+        drain_epoch.fetch_add(1);
+        wake(space_seq);
+        wake(data_seq);
+    }
+
+    void shutdown() noexcept
+    {
+        shutdown_flag.store(true);
+        wake(space_seq);
+        wake(data_seq);
+    }
+};
+
+template<typename T, size_t capacity>
+class pcm_ring {
+    static_assert(capacity > 0 && (capacity & (capacity - 1)) == 0, "pcm_ring capacity must be a power of two");
+
+    std::unique_ptr<T[]> data = std::make_unique<T[]>(capacity);
+
+    alignas(64) std::atomic<size_t> head{ 0 };
+    alignas(64) std::atomic<size_t> tail{ 0 };
+
+    alignas(64) std::atomic<uint32_t> space_seq{ 0 };
+    std::atomic<bool> producer_waiting{ false };
+    std::atomic<bool> shutdown_flag{ false };
+
+    void advance_head(size_t h)
+    {
+        head.store(h, std::memory_order_release);
+        if (producer_waiting.exchange(false)) wake();
+    }
+
+public:
+    static constexpr size_t max_size = capacity;
+
+    pcm_ring() = default;
+    ~pcm_ring() { shutdown(); }
+
+    pcm_ring(const pcm_ring&) = delete;
+    pcm_ring& operator=(const pcm_ring&) = delete;
+
+    size_t size() const { return tail.load(std::memory_order_acquire) - head.load(std::memory_order_acquire); }
+    size_t space() const { return capacity - size(); }
+
+    // Producer side. Never blocks; returns how many samples fitted.
+    size_t write(const T* src, size_t n)
+    {
+        size_t t = tail.load(std::memory_order_relaxed);
+        n = std::min(n, capacity - (t - head.load(std::memory_order_acquire)));
+
+        size_t pos = t & (capacity - 1);
+        size_t first = std::min(n, capacity - pos);
+        std::copy_n(src, first, data.get() + pos);
+        std::copy_n(src + first, n - first, data.get());
+
+        tail.store(t + n, std::memory_order_release);
+        return n;
+    }
+
+    // Producer side. Blocks until n samples fit, or stop() / shutdown / wake() says otherwise.
+    template<typename Pred>
+    bool wait_space(size_t n, Pred stop)
+    {
+        while (space() < n)
+        {
+            uint32_t seq = space_seq.load();
+            producer_waiting.store(true);
+            if (stop() || shutdown_flag.load())
+            {
+                producer_waiting.store(false);
+                return false;
+            }
+            if (space() < n)
+                space_seq.wait(seq);
+            producer_waiting.store(false);
+        }
+        return true;
+    }
+
+    // Consumer side. Never blocks; safe to call from a real-time audio callback.
+    size_t read(T* dst, size_t n)
+    {
+        size_t h = head.load(std::memory_order_relaxed);
+        n = std::min(n, tail.load(std::memory_order_acquire) - h);
+
+        size_t pos = h & (capacity - 1);
+        size_t first = std::min(n, capacity - pos);
+        std::copy_n(data.get() + pos, first, dst);
+        std::copy_n(data.get(), n - first, dst + first);
+
+        advance_head(h + n);
+        return n;
+    }
+
+    size_t skip(size_t n)
+    {
+        size_t h = head.load(std::memory_order_relaxed);
+        n = std::min(n, tail.load(std::memory_order_acquire) - h);
+        advance_head(h + n);
+        return n;
+    }
+
+    void wake()
+    {
+        space_seq.fetch_add(1);
+        space_seq.notify_all();
+    }
+
+    void shutdown() noexcept
+    {
+        shutdown_flag.store(true);
+        wake();
+    }
+};
+
+inline uint16_t bswap16(uint16_t x)
+{
+	return ((x & 0xFF00) >> 8) |
+		((x & 0x00FF) << 8);
+}
+
+inline uint32_t bswap32(uint32_t x)
+{
+	return ((x & 0xFF000000) >> 24) |
+		((x & 0x00FF0000) >> 8) |
+		((x & 0x0000FF00) << 8) |
+		((x & 0x000000FF) << 24);
+}
+
+inline bool is_valid_atom_type(const char* type_buf)
+{
+	for (int i = 0; i < 4; ++i)
+	{
+		unsigned char c = static_cast<unsigned char>(type_buf[i]);
+		if (c < 32 || c > 126) return false;
+	}
+	return true;
+}
+
 #endif
\ No newline at end of file
@@ -0,0 +1,33 @@
+# Plays MEDIA twice with PLAYER under the virtual clock. Both runs must present the same number of frames, with
+# nothing dropped or skipped; FRAMES, when given, pins the count.
+# cmake -DPLAYER=<mplayer> -DMEDIA=<file> [-DFRAMES=<n>] -P virtual_clock_test.cmake
+
+foreach(run 1 2)
+	execute_process(COMMAND ${PLAYER} --virtual-clock ${MEDIA}
+		OUTPUT_VARIABLE output
+		ERROR_VARIABLE output
+		RESULT_VARIABLE result)
+
+	if(NOT result EQUAL 0)
+		message(FATAL_ERROR "run ${run}: mplayer exited with ${result}\n${output}")
+	endif()
+
+	if(NOT output MATCHES "virtual clock: ([0-9]+) frames, ([0-9]+) dropped, ([0-9]+) skipped")
+		message(FATAL_ERROR "run ${run}: no virtual clock summary\n${output}")
+	endif()
+
+	set(frames_${run} ${CMAKE_MATCH_1})
+	message(STATUS "run ${run}: ${CMAKE_MATCH_1} frames, ${CMAKE_MATCH_2} dropped, ${CMAKE_MATCH_3} skipped")
+
+	if(CMAKE_MATCH_1 EQUAL 0 OR NOT CMAKE_MATCH_2 EQUAL 0 OR NOT CMAKE_MATCH_3 EQUAL 0)
+		message(FATAL_ERROR "run ${run}: expected frames with none dropped or skipped")
+	endif()
+endforeach()
+
+if(NOT frames_1 EQUAL frames_2)
+	message(FATAL_ERROR "presented ${frames_1} frames, then ${frames_2}")
+endif()
+
+if(DEFINED FRAMES AND NOT FRAMES STREQUAL "" AND NOT frames_1 EQUAL FRAMES)
+	message(FATAL_ERROR "presented ${frames_1} frames, expected ${FRAMES}")
+endif()
\ No newline at end of file